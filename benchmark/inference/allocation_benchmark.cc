@@ -0,0 +1,160 @@
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <string>
+
+#include <signal.h>
+#include <sys/prctl.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <benchmark/benchmark.h>
+
+#include "benchmark/inference/mock_inference_server.h"
+#include "huggingface_api_cpp/inference.h"
+
+using namespace huggingface_api_cpp::inference;
+using huggingface_api_cpp::benchmark::MockInferenceServer;
+using huggingface_api_cpp::benchmark::MockServerConfig;
+
+// Counts the heap allocations of the steady-state calls of `HfInference` against a `MockInferenceServer`, with each
+// transport and several request sizes. The mock server runs in a child process, so that every allocation of this
+// process is made by the client: by the calling thread, the I/O threads, libcurl, and curlpp.
+//
+// The allocations are counted by interposing the allocation functions of glibc, so this is Linux-only, like the mock
+// server.
+
+std::atomic<std::uint64_t> num_allocations = 0;
+std::atomic<std::uint64_t> num_allocated_bytes = 0;
+
+extern "C" {
+
+void* __libc_malloc(std::size_t size);
+void* __libc_calloc(std::size_t num, std::size_t size);
+void* __libc_realloc(void* pointer, std::size_t size);
+void* __libc_memalign(std::size_t alignment, std::size_t size);
+
+void* malloc(std::size_t size) {
+  num_allocations.fetch_add(1, std::memory_order_relaxed);
+  num_allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+  return __libc_malloc(size);
+}
+
+void* calloc(std::size_t num, std::size_t size) {
+  num_allocations.fetch_add(1, std::memory_order_relaxed);
+  num_allocated_bytes.fetch_add(num * size, std::memory_order_relaxed);
+  return __libc_calloc(num, size);
+}
+
+void* realloc(void* pointer, std::size_t size) {
+  num_allocations.fetch_add(1, std::memory_order_relaxed);
+  num_allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+  return __libc_realloc(pointer, size);
+}
+
+void* aligned_alloc(std::size_t alignment, std::size_t size) {
+  num_allocations.fetch_add(1, std::memory_order_relaxed);
+  num_allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+  return __libc_memalign(alignment, size);
+}
+
+int posix_memalign(void** pointer, std::size_t alignment, std::size_t size) {
+  num_allocations.fetch_add(1, std::memory_order_relaxed);
+  num_allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+  *pointer = __libc_memalign(alignment, size);
+  return *pointer != nullptr ? 0 : ENOMEM;
+}
+
+}  // extern "C"
+
+// Runs a `MockInferenceServer` in a child process until this process exits.
+class MockServerProcess {
+ public:
+  MockServerProcess(const MockServerConfig& config) {
+    int port_pipe[2];
+    if (pipe(port_pipe) != 0) {
+      std::abort();
+    }
+    pid_ = fork();
+    if (pid_ == 0) {
+      prctl(PR_SET_PDEATHSIG, SIGKILL);
+      close(port_pipe[0]);
+      MockInferenceServer mock_server(config);
+      const std::string endpoint = mock_server.endpoint();
+      [[maybe_unused]] const ssize_t size = write(port_pipe[1], endpoint.data(), endpoint.size());
+      close(port_pipe[1]);
+      pause();
+      std::_Exit(EXIT_SUCCESS);
+    }
+
+    close(port_pipe[1]);
+    char buffer[256];
+    const ssize_t size = read(port_pipe[0], buffer, sizeof(buffer));
+    close(port_pipe[0]);
+    if (size <= 0) {
+      std::abort();
+    }
+    endpoint_.assign(buffer, size);
+  }
+
+  ~MockServerProcess() {
+    kill(pid_, SIGKILL);
+    waitpid(pid_, nullptr, 0);
+  }
+
+  const std::string& endpoint() const {
+    return endpoint_;
+  }
+
+ private:
+  pid_t pid_ = -1;
+  std::string endpoint_;
+};
+
+MockServerProcess& ServerProcess(std::size_t response_bytes) {
+  static MockServerProcess small_server_process(MockServerConfig{.response_bytes = 256});
+  static MockServerProcess large_server_process(MockServerConfig{.response_bytes = 64 * 1024});
+  return response_bytes <= 256 ? small_server_process : large_server_process;
+}
+
+// Arguments: the transport (0 for `EasyTransport`, 1 for `MultiTransport`), the size of the input text, and the size
+// of the response body.
+void BM_TextClassification(benchmark::State& state) {
+  HfInference hf_inference;
+  hf_inference.setEndpoint(ServerProcess(state.range(2)).endpoint());
+  if (state.range(0) == 1) {
+    hf_inference.setTransport(std::make_shared<MultiTransport>());
+  }
+  const Args args{.model = "mock/model"};
+  const TextClassificationArgs other_args{.inputs = std::string(state.range(1), 'a')};
+
+  // Warms the connection and the pools up.
+  for (int i = 0; i < 16; ++i) {
+    benchmark::DoNotOptimize(hf_inference.textClassification(args, other_args));
+  }
+
+  const std::uint64_t start_num_allocations = num_allocations.load();
+  const std::uint64_t start_num_allocated_bytes = num_allocated_bytes.load();
+  for (auto _ : state) {
+    std::string output_string = hf_inference.textClassification(args, other_args);
+    if (output_string.size() != static_cast<std::size_t>(state.range(2))) {
+      state.SkipWithError("Unexpected response.");
+      break;
+    }
+    benchmark::DoNotOptimize(output_string);
+  }
+
+  state.counters["allocs/op"] = benchmark::Counter(static_cast<double>(num_allocations.load() - start_num_allocations),
+                                                   benchmark::Counter::kAvgIterations);
+  state.counters["alloc_bytes/op"] = benchmark::Counter(
+      static_cast<double>(num_allocated_bytes.load() - start_num_allocated_bytes), benchmark::Counter::kAvgIterations);
+}
+
+BENCHMARK(BM_TextClassification)
+    ->ArgNames({"transport", "input_bytes", "response_bytes"})
+    ->ArgsProduct({{0, 1}, {16, 4096}, {256, 64 * 1024}})
+    ->UseRealTime();
+
+BENCHMARK_MAIN();
@@ -0,0 +1,166 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <zlib.h>
+
+#include <benchmark/benchmark.h>
+
+#include "benchmark/inference/mock_inference_server.h"
+#include "huggingface_api_cpp/inference.h"
+
+using namespace huggingface_api_cpp::inference;
+using huggingface_api_cpp::benchmark::MockInferenceServer;
+using huggingface_api_cpp::benchmark::MockServerConfig;
+
+// Weighs the bytes on the wire against the CPU time of the compression of the bodies:
+// - `BM_CompressBody` compresses the JSON request bodies of the calls that carry the most text, a table question and
+//   a conversation, with each encoding and level, and reports the size of the body before and after.
+// - `BM_Call` makes whole calls against a `MockInferenceServer` that gzips its responses, with and without accepting
+//   encoded responses and compressing the request, and reports the bytes sent and received per call, as counted by
+//   libcurl, next to the CPU time of the calling thread, which encodes the request and decodes the response.
+
+// Text of about `size` bytes made of words in a pseudo-random order, which compresses about as well as natural text.
+std::string MakeText(std::size_t size) {
+  static constexpr std::string_view kWords[] = {
+      "the ", "model ", "repository ", "stars ", "question ", "answer ", "of ", "and ",
+      "how ", "many ", "transformers ", "datasets ", "42 ", "1024 ", "3.14 ", "why ",
+  };
+  std::string text;
+  std::uint32_t state = 1;
+  while (text.size() < size) {
+    state = state * 1664525 + 1013904223;
+    text += kWords[state >> 28];
+  }
+  text.resize(size);
+  return text;
+}
+
+// Cells or messages of 64 bytes, cut from one text so that they differ.
+std::vector<std::string> MakeTexts(std::size_t size) {
+  const std::string text = MakeText(std::max<std::size_t>(size, 64));
+  std::vector<std::string> texts;
+  for (std::size_t begin = 0; begin + 64 <= text.size(); begin += 64) {
+    texts.push_back(text.substr(begin, 64));
+  }
+  return texts;
+}
+
+TableQuestionAnswerArgs MakeTableQuestionAnswerArgs(std::size_t size) {
+  return {
+      .inputs = {.query = "How many?", .table = {{"Repository", MakeTexts(size / 2)}, {"Stars", MakeTexts(size / 2)}}},
+  };
+}
+
+ConversationalArgs MakeConversationalArgs(std::size_t size) {
+  return {
+      .inputs = {.past_user_inputs = MakeTexts(size / 2), .generated_responses = MakeTexts(size / 2), .text = "Why?"},
+      .parameters_opt = ConversationalArgs::Parameters{},
+  };
+}
+
+// Decodes a gzip or zlib body, to check the round trip.
+std::string Decompress(std::string_view data, std::size_t size) {
+  std::string output(size, '\0');
+  z_stream stream{};
+  inflateInit2(&stream, 32 + MAX_WBITS);  // 32 more window bits detect the gzip or zlib wrapper.
+  stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+  stream.avail_in = static_cast<uInt>(data.size());
+  stream.next_out = reinterpret_cast<Bytef*>(output.data());
+  stream.avail_out = static_cast<uInt>(output.size());
+  const int result = inflate(&stream, Z_FINISH);
+  output.resize(stream.total_out);
+  inflateEnd(&stream);
+  return result == Z_STREAM_END ? output : std::string();
+}
+
+// Arguments: the content encoding (1 for gzip, 2 for deflate), the level, and the size of the input.
+template <typename T, T (*MakeArgs)(std::size_t)>
+void BM_CompressBody(benchmark::State& state) {
+  const ContentEncoding content_encoding = static_cast<ContentEncoding>(state.range(0));
+  const int level = static_cast<int>(state.range(1));
+  const std::string body = MakeBodyFromJson(MakeArgs(static_cast<std::size_t>(state.range(2))), Options{});
+
+  std::string compressed_body;
+  if (!CompressBody(body, content_encoding, level, compressed_body) ||
+      Decompress(compressed_body, body.size()) != body) {
+    state.SkipWithError("The compressed body does not decompress to the body.");
+    return;
+  }
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(CompressBody(body, content_encoding, level, compressed_body));
+    benchmark::DoNotOptimize(compressed_body.data());
+  }
+
+  state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * body.size()));
+  state.counters["body_bytes"] = static_cast<double>(body.size());
+  state.counters["wire_bytes"] = static_cast<double>(compressed_body.size());
+  state.counters["ratio"] = static_cast<double>(body.size()) / static_cast<double>(compressed_body.size());
+}
+
+void CompressBodyArgs(benchmark::internal::Benchmark* benchmark) {
+  benchmark->ArgNames({"encoding", "level", "input_bytes"});
+  for (const std::int64_t input_bytes : {1024, 64 * 1024, 1024 * 1024}) {
+    for (const std::int64_t encoding : {1, 2}) {
+      for (const std::int64_t level : {1, 6, 9}) {
+        benchmark->Args({encoding, level, input_bytes});
+      }
+    }
+  }
+}
+
+BENCHMARK_TEMPLATE(BM_CompressBody, TableQuestionAnswerArgs, MakeTableQuestionAnswerArgs)->Apply(CompressBodyArgs);
+BENCHMARK_TEMPLATE(BM_CompressBody, ConversationalArgs, MakeConversationalArgs)->Apply(CompressBodyArgs);
+
+MockInferenceServer& Server(std::size_t response_bytes) {
+  static MockInferenceServer small_server(MockServerConfig{.response_bytes = 4 * 1024, .gzip_responses = true});
+  static MockInferenceServer large_server(MockServerConfig{.response_bytes = 256 * 1024, .gzip_responses = true});
+  return response_bytes <= 4 * 1024 ? small_server : large_server;
+}
+
+// Arguments: whether encoded responses are accepted, whether the request is gzipped, the size of the input, and the
+// size of the response body.
+void BM_Call(benchmark::State& state) {
+  MockInferenceServer& server = Server(state.range(3));
+  HfInference hf_inference;
+  hf_inference.setEndpoint(server.endpoint());
+  hf_inference.enableRequestMetrics();
+  const Args args{.model = "mock/model"};
+  const TableQuestionAnswerArgs other_args = MakeTableQuestionAnswerArgs(state.range(2));
+  Options options;
+  options.compression_policy.accept_encoded_responses = state.range(0) != 0;
+  options.compression_policy.request_encoding =
+      state.range(1) != 0 ? ContentEncoding::kGzip : ContentEncoding::kIdentity;
+  options.compression_policy.min_request_bytes = 0;
+
+  // Warms the connection and the pools up.
+  for (int i = 0; i < 16; ++i) {
+    benchmark::DoNotOptimize(hf_inference.tableQuestionAnswer(args, other_args, options));
+  }
+  const RequestMetricsSnapshot start_metrics = hf_inference.requestMetrics().front();
+
+  for (auto _ : state) {
+    std::string output_string = hf_inference.tableQuestionAnswer(args, other_args, options);
+    if (output_string != server.responseBody()) {
+      state.SkipWithError("Unexpected response.");
+      break;
+    }
+    benchmark::DoNotOptimize(output_string);
+  }
+
+  const RequestMetricsSnapshot metrics = hf_inference.requestMetrics().front();
+  state.counters["sent_bytes/op"] = benchmark::Counter(
+      static_cast<double>(metrics.bytes_sent - start_metrics.bytes_sent), benchmark::Counter::kAvgIterations);
+  state.counters["received_bytes/op"] = benchmark::Counter(
+      static_cast<double>(metrics.bytes_received - start_metrics.bytes_received), benchmark::Counter::kAvgIterations);
+}
+
+BENCHMARK(BM_Call)
+    ->ArgNames({"accept_encoding", "gzip_request", "input_bytes", "response_bytes"})
+    ->ArgsProduct({{0, 1}, {0, 1}, {64 * 1024}, {4 * 1024, 256 * 1024}});
+
+BENCHMARK_MAIN();
@@ -0,0 +1,238 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <ctime>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "benchmark/inference/mock_inference_server.h"
+#include "huggingface_api_cpp/inference.h"
+
+using namespace huggingface_api_cpp::inference;
+using huggingface_api_cpp::benchmark::MockInferenceServer;
+using huggingface_api_cpp::benchmark::MockServerConfig;
+
+// Load-tests every task of `HfInference` against an in-process `MockInferenceServer`: `--concurrency` threads make
+// synchronous calls back to back for `--duration_ms` per task. Reports the throughput, the latency percentiles, and
+// the CPU time of the client per request, i.e. the CPU time of the process minus that of the server thread.
+//
+// Flags (all optional):
+//   --concurrency=16      Threads calling concurrently, i.e. requests in flight.
+//   --duration_ms=2000    Per task.
+//   --latency_us=1000     Server-side latency of each response.
+//   --request_bytes=256   Size of the text inputs, and of the binary inputs of the audio and image tasks.
+//   --response_bytes=256  Size of each response body.
+//   --transport=easy      `easy` (EasyTransport) or `multi` (MultiTransport).
+//   --task=NAME           Only runs the task of that method name, e.g. `textClassification`.
+
+struct Flags {
+  int concurrency = 16;
+  int duration_ms = 2000;
+  int latency_us = 1000;
+  int request_bytes = 256;
+  int response_bytes = 256;
+  std::string transport = "easy";
+  std::string task;
+};
+
+Flags ParseFlags(const int argc, const char* argv[]) {
+  Flags flags;
+  for (int i = 1; i < argc; ++i) {
+    const std::string_view arg = argv[i];
+    const std::size_t separator = arg.find('=');
+    const std::string_view name = arg.substr(0, separator);
+    const std::string value(separator != std::string_view::npos ? arg.substr(separator + 1) : "");
+    if (name == "--concurrency") {
+      flags.concurrency = std::max(std::atoi(value.c_str()), 1);
+    } else if (name == "--duration_ms") {
+      flags.duration_ms = std::atoi(value.c_str());
+    } else if (name == "--latency_us") {
+      flags.latency_us = std::atoi(value.c_str());
+    } else if (name == "--request_bytes") {
+      flags.request_bytes = std::atoi(value.c_str());
+    } else if (name == "--response_bytes") {
+      flags.response_bytes = std::atoi(value.c_str());
+    } else if (name == "--transport") {
+      flags.transport = value;
+    } else if (name == "--task") {
+      flags.task = value;
+    } else {
+      std::cerr << "Unknown flag: " << arg << std::endl;
+      std::exit(EXIT_FAILURE);
+    }
+  }
+  return flags;
+}
+
+// Returns whether the call received the response of the mock server.
+using Task = std::function<bool(const HfInference& hf_inference)>;
+
+std::vector<std::pair<std::string, Task>> MakeTasks(const std::string& text, const std::vector<char>& data,
+                                                    const std::string& response_body) {
+  const Args args{.model = "mock/model"};
+  const std::span<const char> data_buffer(data);
+  auto is_expected = [response_body](const std::string& output_string) {
+    return output_string == response_body;
+  };
+
+  return {
+      {"fillMask", [=](const HfInference& hf) {
+        return is_expected(hf.fillMask(args, {.inputs = text}));
+      }},
+      {"summarization", [=](const HfInference& hf) {
+        return is_expected(hf.summarization(args, {.inputs = text}));
+      }},
+      {"questionAnswer", [=](const HfInference& hf) {
+        return is_expected(hf.questionAnswer(args, {.inputs = {.question = "Which one?", .context = text}}));
+      }},
+      {"tableQuestionAnswer", [=](const HfInference& hf) {
+        return is_expected(
+            hf.tableQuestionAnswer(args, {.inputs = {.query = "Which one?", .table = {{"text", {text}}}}}));
+      }},
+      {"textClassification", [=](const HfInference& hf) {
+        return is_expected(hf.textClassification(args, {.inputs = text}));
+      }},
+      {"textGeneration", [=](const HfInference& hf) {
+        return is_expected(hf.textGeneration(args, {.inputs = text}));
+      }},
+      {"tokenClassification", [=](const HfInference& hf) {
+        return is_expected(hf.tokenClassification(args, {.inputs = text}));
+      }},
+      {"translation", [=](const HfInference& hf) {
+        return is_expected(hf.translation(args, {.inputs = text}));
+      }},
+      {"zeroShotClassification", [=](const HfInference& hf) {
+        return is_expected(hf.zeroShotClassification(
+            args, {.inputs = {text}, .parameters_opt = ZeroShotClassificationArgs::Parameters{{"a", "b"}}}));
+      }},
+      {"conversational", [=](const HfInference& hf) {
+        return is_expected(hf.conversational(args, {.inputs = {.text = text}}));
+      }},
+      {"automaticSpeechRecognition", [=](const HfInference& hf) {
+        return is_expected(hf.automaticSpeechRecognition(args, {.data_buffer = data_buffer}));
+      }},
+      {"audioClassification", [=](const HfInference& hf) {
+        return is_expected(hf.audioClassification(args, {.data_buffer = data_buffer}));
+      }},
+      {"imageClassification", [=](const HfInference& hf) {
+        return is_expected(hf.imageClassification(args, {.data_buffer = data_buffer}));
+      }},
+      {"objectDetection", [=](const HfInference& hf) {
+        return is_expected(hf.objectDetection(args, {.data_buffer = data_buffer}));
+      }},
+      {"imageSegmentation", [=](const HfInference& hf) {
+        return is_expected(hf.imageSegmentation(args, {.data_buffer = data_buffer}));
+      }},
+      {"textToImage", [=](const HfInference& hf) {
+        const BlobOutput blob_output = hf.textToImageBytes(args, {.inputs = text});
+        return blob_output.response_code == 200 && is_expected(blob_output.data);
+      }},
+  };
+}
+
+std::chrono::nanoseconds ProcessCpuTime() {
+  timespec time{};
+  clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &time);
+  return std::chrono::seconds(time.tv_sec) + std::chrono::nanoseconds(time.tv_nsec);
+}
+
+// `sorted_latencies` must not be empty.
+double PercentileUs(const std::vector<std::chrono::nanoseconds>& sorted_latencies, double percentile) {
+  const std::size_t rank = static_cast<std::size_t>(percentile * static_cast<double>(sorted_latencies.size()));
+  const std::size_t index = std::min(rank, sorted_latencies.size() - 1);
+  return std::chrono::duration<double, std::micro>(sorted_latencies[index]).count();
+}
+
+int main(const int argc, const char* argv[]) {
+  const Flags flags = ParseFlags(argc, argv);
+
+  MockInferenceServer mock_server(MockServerConfig{
+      .latency = std::chrono::microseconds(flags.latency_us),
+      .response_bytes = static_cast<std::size_t>(flags.response_bytes),
+  });
+  HfInference hf_inference;
+  hf_inference.setEndpoint(mock_server.endpoint());
+  if (flags.transport == "multi") {
+    hf_inference.setTransport(std::make_shared<MultiTransport>());
+  }
+
+  const std::string text(flags.request_bytes, 'a');
+  const std::vector<char> data(flags.request_bytes, '\x7f');
+  const std::string response_body(mock_server.responseBody());
+
+  std::cout << "concurrency: " << flags.concurrency << ", transport: " << flags.transport
+            << ", server latency: " << flags.latency_us << " us, request: " << flags.request_bytes
+            << " bytes, response: " << flags.response_bytes << " bytes" << std::endl
+            << std::endl;
+  std::cout << std::left << std::setw(28) << "task" << std::right << std::setw(10) << "req/s" << std::setw(10)
+            << "p50 us" << std::setw(10) << "p99 us" << std::setw(10) << "p999 us" << std::setw(12) << "cpu us/req"
+            << std::setw(8) << "errors" << std::endl;
+
+  bool is_successful = true;
+  for (const auto& [name, task] : MakeTasks(text, data, response_body)) {
+    if (!flags.task.empty() && flags.task != name) {
+      continue;
+    }
+
+    // Warms the connections up.
+    task(hf_inference);
+
+    std::vector<std::vector<std::chrono::nanoseconds>> thread_latencies(flags.concurrency);
+    std::atomic<std::uint64_t> num_errors = 0;
+    const std::chrono::nanoseconds start_cpu_time = ProcessCpuTime();
+    const std::chrono::nanoseconds start_server_cpu_time = mock_server.cpuTime();
+    const auto start_time = std::chrono::steady_clock::now();
+    const auto end_time = start_time + std::chrono::milliseconds(flags.duration_ms);
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < flags.concurrency; ++i) {
+      threads.emplace_back([&, i]() {
+        std::vector<std::chrono::nanoseconds>& latencies = thread_latencies[i];
+        while (std::chrono::steady_clock::now() < end_time) {
+          const auto call_start_time = std::chrono::steady_clock::now();
+          if (!task(hf_inference)) {
+            num_errors.fetch_add(1, std::memory_order_relaxed);
+          }
+          latencies.push_back(std::chrono::steady_clock::now() - call_start_time);
+        }
+      });
+    }
+    for (std::thread& thread : threads) {
+      thread.join();
+    }
+
+    const std::chrono::duration<double> elapsed_time = std::chrono::steady_clock::now() - start_time;
+    const std::chrono::nanoseconds client_cpu_time =
+        (ProcessCpuTime() - start_cpu_time) - (mock_server.cpuTime() - start_server_cpu_time);
+
+    std::vector<std::chrono::nanoseconds> latencies;
+    for (const std::vector<std::chrono::nanoseconds>& thread_latency : thread_latencies) {
+      latencies.insert(latencies.end(), thread_latency.begin(), thread_latency.end());
+    }
+    if (latencies.empty()) {
+      continue;
+    }
+    std::sort(latencies.begin(), latencies.end());
+
+    const double num_requests = static_cast<double>(latencies.size());
+    std::cout << std::left << std::setw(28) << name << std::right << std::fixed << std::setprecision(0)
+              << std::setw(10) << num_requests / elapsed_time.count() << std::setw(10)
+              << PercentileUs(latencies, 0.5) << std::setw(10) << PercentileUs(latencies, 0.99) << std::setw(10)
+              << PercentileUs(latencies, 0.999) << std::setw(12) << std::setprecision(1)
+              << std::chrono::duration<double, std::micro>(client_cpu_time).count() / num_requests << std::setw(8)
+              << num_errors.load() << std::endl;
+    is_successful = is_successful && num_errors.load() == 0;
+  }
+
+  return is_successful ? EXIT_SUCCESS : EXIT_FAILURE;
+}
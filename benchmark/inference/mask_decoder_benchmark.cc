@@ -0,0 +1,97 @@
+#include <cassert>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "huggingface_api_cpp/inference.h"
+
+using namespace huggingface_api_cpp::inference;
+
+// Measures the throughput of `DecodeMask()` for each `Base64Decoder` supported by the CPU, on the base64 encodings of
+// the test images, which stand in for the masks returned by `imageSegmentation()`.
+
+std::string EncodeBase64(const std::string& data) {
+  constexpr std::string_view kAlphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+  std::string encoded;
+  encoded.reserve((data.size() + 2) / 3 * 4);
+  for (std::size_t i = 0; i < data.size(); i += 3) {
+    const std::size_t n = std::min<std::size_t>(3, data.size() - i);
+    std::uint32_t triple = static_cast<unsigned char>(data[i]) << 16;
+    if (1 < n) {
+      triple |= static_cast<unsigned char>(data[i + 1]) << 8;
+    }
+    if (2 < n) {
+      triple |= static_cast<unsigned char>(data[i + 2]);
+    }
+    encoded += kAlphabet[(triple >> 18) & 0x3F];
+    encoded += kAlphabet[(triple >> 12) & 0x3F];
+    encoded += (1 < n) ? kAlphabet[(triple >> 6) & 0x3F] : '=';
+    encoded += (2 < n) ? kAlphabet[triple & 0x3F] : '=';
+  }
+  return encoded;
+}
+
+const char* NameOf(Base64Decoder decoder) {
+  switch (decoder) {
+    case Base64Decoder::kScalar:
+      return "scalar";
+    case Base64Decoder::kSse:
+      return "sse";
+    case Base64Decoder::kAvx2:
+      return "avx2";
+  }
+  return "";
+}
+
+int main(const int argc, const char* argv[]) {
+  assert(2 <= argc);
+  const std::filesystem::path directory_path = argv[1];
+  const int num_iterations = (3 <= argc) ? std::atoi(argv[2]) : 200;
+
+  std::cout << "best decoder: " << NameOf(BestBase64Decoder()) << std::endl << std::endl;
+
+  for (const char* file_name : {"blob.png", "cats.png", "cheetah.png"}) {
+    std::ifstream file_stream(directory_path / "test" / file_name, std::ios::in | std::ios::binary);
+    const std::string data((std::istreambuf_iterator<char>(file_stream)), std::istreambuf_iterator<char>());
+    const std::string mask = EncodeBase64(data);
+    std::cout << file_name << " (" << mask.size() << " base64 bytes)" << std::endl;
+
+    double scalar_gb_per_s = 0.0;
+    for (const Base64Decoder decoder : {Base64Decoder::kScalar, Base64Decoder::kSse, Base64Decoder::kAvx2}) {
+      if (!IsSupported(decoder)) {
+        std::cout << "  " << std::setw(6) << NameOf(decoder) << ": not supported" << std::endl;
+        continue;
+      }
+
+      // The buffer is reused across iterations, as with a `MaskBufferPool`.
+      std::vector<char> png;
+      if (!DecodeMask(mask, png, decoder) || std::string_view(png.data(), png.size()) != data) {
+        std::cerr << "  " << NameOf(decoder) << ": wrong output" << std::endl;
+        return EXIT_FAILURE;
+      }
+
+      const auto start_time = std::chrono::steady_clock::now();
+      for (int i = 0; i < num_iterations; ++i) {
+        DecodeMask(mask, png, decoder);
+      }
+      const std::chrono::duration<double> elapsed_time = std::chrono::steady_clock::now() - start_time;
+
+      const double gb_per_s = static_cast<double>(mask.size()) * num_iterations / elapsed_time.count() / 1e9;
+      if (decoder == Base64Decoder::kScalar) {
+        scalar_gb_per_s = gb_per_s;
+      }
+      std::cout << "  " << std::setw(6) << NameOf(decoder) << ": " << std::fixed << std::setprecision(2)
+                << gb_per_s << " GB/s (x" << gb_per_s / scalar_gb_per_s << ")" << std::endl;
+    }
+    std::cout << std::endl;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,377 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <functional>
+#include <queue>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <pthread.h>
+#include <strings.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+#include "huggingface_api_cpp/inference/compression.h"
+
+namespace huggingface_api_cpp::benchmark {
+
+struct MockServerConfig {
+  std::chrono::microseconds latency = std::chrono::microseconds(0);  // Between a request and its response.
+  std::size_t response_bytes = 256;                                  // Size of every response body.
+  bool gzip_responses = false;  // Whether the requests that accept gzip are answered with a gzip-encoded body.
+};
+
+// A minimal HTTP/1.1 server on 127.0.0.1 standing in for the Inference API, so that the client can be load-tested
+// without the network. It answers every POST with 200 and the same JSON body after `latency`, whatever the model. The
+// body is padded with words, so that it compresses about as well as the usual JSON outputs.
+// One thread serves all the keep-alive connections with epoll, and does little work, so that its CPU time can be told
+// apart from the client's.
+class MockInferenceServer {
+ public:
+  MockInferenceServer(const MockServerConfig& config = MockServerConfig())
+      : config_(config),
+        body_(MakeBody(config.response_bytes)),
+        response_(MakeResponse(body_, "")),
+        gzip_response_(config.gzip_responses ? MakeResponse(body_, "gzip") : "") {
+    listen_fd_ = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    const int one = 1;
+    setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = 0;  // Any free port.
+    socklen_t address_size = sizeof(address);
+    if (bind(listen_fd_, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+        listen(listen_fd_, SOMAXCONN) != 0 ||
+        getsockname(listen_fd_, reinterpret_cast<sockaddr*>(&address), &address_size) != 0) {
+      close(listen_fd_);
+      throw std::runtime_error("MockInferenceServer: cannot listen on 127.0.0.1.");
+    }
+    port_ = ntohs(address.sin_port);
+
+    epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+    wakeup_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    timer_fd_ = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    for (const int fd : {listen_fd_, wakeup_fd_, timer_fd_}) {
+      epoll_event event{};
+      event.events = EPOLLIN;
+      event.data.u64 = static_cast<std::uint64_t>(fd);
+      epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &event);
+    }
+
+    thread_ = std::thread([this]() { run(); });
+  }
+
+  MockInferenceServer(const MockInferenceServer&) = delete;
+  MockInferenceServer& operator=(const MockInferenceServer&) = delete;
+
+  ~MockInferenceServer() {
+    stopping_ = true;
+    const std::uint64_t one = 1;
+    [[maybe_unused]] const ssize_t size = write(wakeup_fd_, &one, sizeof(one));
+    thread_.join();
+
+    for (const auto& [id, connection] : connections_) {
+      close(connection.fd);
+    }
+    for (const int fd : {listen_fd_, wakeup_fd_, timer_fd_, epoll_fd_}) {
+      close(fd);
+    }
+  }
+
+  // To pass to `HfInference::setEndpoint()`.
+  std::string endpoint() const {
+    return "http://127.0.0.1:" + std::to_string(port_) + "/models/";
+  }
+
+  std::string_view responseBody() const {
+    return body_;
+  }
+
+  // The size of the body as sent to the requests that accept gzip, if `gzip_responses`.
+  std::size_t gzipResponseBodySize() const {
+    return gzip_response_.size() - gzip_response_.find("\r\n\r\n") - 4;
+  }
+
+  std::uint64_t numRequests() const {
+    return num_requests_.load(std::memory_order_relaxed);
+  }
+
+  // The CPU time consumed by the server thread so far.
+  std::chrono::nanoseconds cpuTime() const {
+    clockid_t clock_id;
+    timespec time{};
+    if (pthread_getcpuclockid(const_cast<std::thread&>(thread_).native_handle(), &clock_id) != 0 ||
+        clock_gettime(clock_id, &time) != 0) {
+      return std::chrono::nanoseconds(0);
+    }
+    return std::chrono::seconds(time.tv_sec) + std::chrono::nanoseconds(time.tv_nsec);
+  }
+
+ private:
+  using Clock = std::chrono::steady_clock;
+
+  // Event data values below this are the fds of the server itself, and the others are connection ids.
+  static constexpr std::uint64_t kFirstConnectionId = 1ull << 32;
+
+  struct Connection {
+    std::uint64_t id = 0;
+    int fd = -1;
+    std::string input;
+    std::string output;  // Not written yet because the socket was full.
+    bool is_continue_sent = false;
+  };
+
+  struct ScheduledResponse {
+    Clock::time_point time;
+    std::uint64_t connection_id;
+    bool is_gzip;
+
+    bool operator>(const ScheduledResponse& other) const {
+      return time > other.time;
+    }
+  };
+
+  static std::string MakeBody(std::size_t response_bytes) {
+    // A classification result padded to the configured size, so that the body stays valid JSON. The padding repeats
+    // words in a pseudo-random order, like the labels and numbers of a long output.
+    std::string body = R"([{"label":"POSITIVE","score":0.99,"padding":""}])";
+    if (body.size() < response_bytes) {
+      static constexpr std::string_view kWords[] = {
+          "label ", "score ", "entity ", "0.", "12", "345", "6789", "start ",
+          "end ", "word ", "token ", "mask ", "box ", "xmin ", "ymax ", "none ",
+      };
+      std::string padding;
+      std::uint32_t state = 1;
+      while (padding.size() < response_bytes - body.size()) {
+        state = state * 1664525 + 1013904223;
+        padding += kWords[state >> 28];
+      }
+      padding.resize(response_bytes - body.size());
+      body.insert(body.size() - 3, padding);
+    } else {
+      body.resize(response_bytes);
+    }
+    return body;
+  }
+
+  static std::string MakeResponse(const std::string& body, std::string_view content_encoding) {
+    std::string encoded_body = body;
+    std::string content_encoding_header;
+    if (content_encoding == "gzip" &&
+        inference::CompressBody(body, inference::ContentEncoding::kGzip, /*level=*/6, encoded_body)) {
+      content_encoding_header = "Content-Encoding: gzip\r\n";
+    }
+    return "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\n" + content_encoding_header +
+           "Content-Length: " + std::to_string(encoded_body.size()) + "\r\n\r\n" + encoded_body;
+  }
+
+  void run() {
+    std::vector<epoll_event> events(256);
+    while (!stopping_) {
+      const int num_events = epoll_wait(epoll_fd_, events.data(), static_cast<int>(events.size()), -1);
+      for (int i = 0; i < num_events; ++i) {
+        const std::uint64_t data = events[i].data.u64;
+        if (data == static_cast<std::uint64_t>(listen_fd_)) {
+          accept();
+        } else if (data == static_cast<std::uint64_t>(timer_fd_)) {
+          std::uint64_t num_expirations = 0;
+          [[maybe_unused]] const ssize_t size = read(timer_fd_, &num_expirations, sizeof(num_expirations));
+          sendDue();
+        } else if (kFirstConnectionId <= data) {
+          if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) {
+            receive(data);
+          }
+          if (events[i].events & EPOLLOUT) {
+            flush(data);
+          }
+        }
+      }
+    }
+  }
+
+  void accept() {
+    while (true) {
+      const int fd = accept4(listen_fd_, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+      if (fd < 0) {
+        return;
+      }
+      const int one = 1;
+      setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+      const std::uint64_t id = next_connection_id_++;
+      connections_[id] = Connection{id, fd};
+      epoll_event event{};
+      event.events = EPOLLIN;
+      event.data.u64 = id;
+      epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &event);
+    }
+  }
+
+  void receive(std::uint64_t id) {
+    auto it = connections_.find(id);
+    if (it == connections_.end()) {
+      return;
+    }
+    Connection& connection = it->second;
+
+    char buffer[64 * 1024];
+    while (true) {
+      const ssize_t size = read(connection.fd, buffer, sizeof(buffer));
+      if (0 < size) {
+        connection.input.append(buffer, size);
+        continue;
+      }
+      if (size == 0 || (errno != EAGAIN && errno != EWOULDBLOCK)) {
+        close(connection.fd);
+        connections_.erase(it);
+        return;
+      }
+      break;
+    }
+
+    // Each complete request is answered in order. libcurl waits for each response before sending the next request.
+    while (true) {
+      const std::size_t header_end = connection.input.find("\r\n\r\n");
+      if (header_end == std::string::npos) {
+        return;
+      }
+      const std::string_view header(connection.input.data(), header_end + 4);
+      const std::string_view content_length_value = HeaderValue(header, "content-length:");
+      const std::size_t content_length =
+          content_length_value.empty() ? 0 : std::stoull(std::string(content_length_value));
+      if (connection.input.size() < header.size() + content_length) {
+        if (!connection.is_continue_sent && header.find("100-continue") != std::string_view::npos) {
+          connection.is_continue_sent = true;
+          writeOutput(connection, "HTTP/1.1 100 Continue\r\n\r\n");
+        }
+        return;
+      }
+      connection.input.erase(0, header.size() + content_length);
+      connection.is_continue_sent = false;
+      num_requests_.fetch_add(1, std::memory_order_relaxed);
+      const bool is_gzip = config_.gzip_responses &&
+                           HeaderValue(header, "accept-encoding:").find("gzip") != std::string_view::npos;
+
+      if (config_.latency.count() == 0) {
+        writeOutput(connection, is_gzip ? gzip_response_ : response_);
+        continue;
+      }
+      const bool is_earliest = scheduled_.empty() || Clock::now() + config_.latency < scheduled_.top().time;
+      scheduled_.push(ScheduledResponse{Clock::now() + config_.latency, id, is_gzip});
+      if (is_earliest) {
+        armTimer();
+      }
+    }
+  }
+
+  // The value of the first header line starting with `name`, or an empty string if none.
+  static std::string_view HeaderValue(std::string_view header, std::string_view name) {
+    for (std::size_t begin = 0; begin < header.size();) {
+      const std::size_t end = header.find("\r\n", begin);
+      const std::string_view line = header.substr(begin, end - begin);
+      if (name.size() < line.size() && strncasecmp(line.data(), name.data(), name.size()) == 0) {
+        return line.substr(name.size());
+      }
+      begin = end + 2;
+    }
+    return std::string_view();
+  }
+
+  void sendDue() {
+    const Clock::time_point now = Clock::now();
+    while (!scheduled_.empty() && scheduled_.top().time <= now) {
+      const ScheduledResponse scheduled_response = scheduled_.top();
+      scheduled_.pop();
+      auto it = connections_.find(scheduled_response.connection_id);
+      if (it != connections_.end()) {
+        writeOutput(it->second, scheduled_response.is_gzip ? gzip_response_ : response_);
+      }
+    }
+    if (!scheduled_.empty()) {
+      armTimer();
+    }
+  }
+
+  void armTimer() {
+    const auto delay = std::max(scheduled_.top().time - Clock::now(), Clock::duration(1000));
+    itimerspec timer_spec{};
+    timer_spec.it_value.tv_sec = std::chrono::duration_cast<std::chrono::seconds>(delay).count();
+    timer_spec.it_value.tv_nsec = (std::chrono::duration_cast<std::chrono::nanoseconds>(delay) % std::chrono::seconds(1))
+                                      .count();
+    timerfd_settime(timer_fd_, 0, &timer_spec, nullptr);
+  }
+
+  void writeOutput(Connection& connection, std::string_view data) {
+    if (connection.output.empty()) {
+      const ssize_t size = send(connection.fd, data.data(), data.size(), MSG_NOSIGNAL);
+      if (size == static_cast<ssize_t>(data.size())) {
+        return;
+      }
+      data.remove_prefix(std::max<ssize_t>(size, 0));
+    }
+    connection.output.append(data);
+    watchOutput(connection, true);
+  }
+
+  void flush(std::uint64_t id) {
+    auto it = connections_.find(id);
+    if (it == connections_.end()) {
+      return;
+    }
+    Connection& connection = it->second;
+    const ssize_t size = send(connection.fd, connection.output.data(), connection.output.size(), MSG_NOSIGNAL);
+    if (0 < size) {
+      connection.output.erase(0, size);
+    }
+    if (connection.output.empty()) {
+      watchOutput(connection, false);
+    }
+  }
+
+  void watchOutput(const Connection& connection, bool is_watched) {
+    epoll_event event{};
+    event.events = EPOLLIN | (is_watched ? EPOLLOUT : 0);
+    event.data.u64 = connection.id;
+    epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, connection.fd, &event);
+  }
+
+  const MockServerConfig config_;
+  const std::string body_;
+  const std::string response_;
+  const std::string gzip_response_;  // Empty unless `gzip_responses`.
+
+  int listen_fd_ = -1;
+  int epoll_fd_ = -1;
+  int wakeup_fd_ = -1;
+  int timer_fd_ = -1;
+  int port_ = 0;
+  std::thread thread_;
+  std::atomic<bool> stopping_ = false;
+  std::atomic<std::uint64_t> num_requests_ = 0;
+
+  // Only accessed by the server thread.
+  std::unordered_map<std::uint64_t, Connection> connections_;
+  std::uint64_t next_connection_id_ = kFirstConnectionId;
+  std::priority_queue<ScheduledResponse, std::vector<ScheduledResponse>, std::greater<ScheduledResponse>> scheduled_;
+};
+
+}  // namespace huggingface_api_cpp::benchmark
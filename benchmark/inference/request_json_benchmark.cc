@@ -0,0 +1,206 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "huggingface_api_cpp/inference.h"
+
+using namespace huggingface_api_cpp::inference;
+
+// Measures `MakeBodyFromJson()` for every argument type serialized to JSON, at several input sizes, against
+// `MakeBodyFromJsonTree()`, which goes through a nlohmann::json tree. Besides the time per operation, reports the heap
+// allocations per operation, counted by the replaced global `operator new`. Fails a benchmark whose two bodies differ.
+
+struct AllocationStats {
+  std::uint64_t num_allocations = 0;
+  std::uint64_t num_bytes = 0;
+};
+
+thread_local AllocationStats allocation_stats;
+
+void* operator new(std::size_t size) {
+  ++allocation_stats.num_allocations;
+  allocation_stats.num_bytes += size;
+  if (void* pointer = std::malloc(size == 0 ? 1 : size)) {
+    return pointer;
+  }
+  throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) {
+  return operator new(size);
+}
+
+void operator delete(void* pointer) noexcept {
+  std::free(pointer);
+}
+
+void operator delete[](void* pointer) noexcept {
+  std::free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept {
+  std::free(pointer);
+}
+
+void operator delete[](void* pointer, std::size_t) noexcept {
+  std::free(pointer);
+}
+
+// Text of `size` bytes, and lists of about `size` bytes in total made of 64-byte items.
+std::string MakeText(std::size_t size) {
+  std::string text(size, 'a');
+  for (std::size_t i = 5; i < size; i += 6) {
+    text[i] = ' ';
+  }
+  return text;
+}
+
+std::vector<std::string> MakeTexts(std::size_t size) {
+  return std::vector<std::string>(std::max<std::size_t>(size / 64, 1), MakeText(std::min<std::size_t>(size, 64)));
+}
+
+template <typename T>
+T MakeArgs(std::size_t size);
+
+template <>
+FillMaskArgs MakeArgs(std::size_t size) {
+  return {.inputs = MakeText(size) + " [MASK]."};
+}
+
+template <>
+SummarizationArgs MakeArgs(std::size_t size) {
+  return {.inputs = MakeText(size), .parameters_opt = SummarizationArgs::Parameters{.max_length_opt = 100}};
+}
+
+template <>
+QuestionAnswerArgs MakeArgs(std::size_t size) {
+  return {.inputs = {.question = "What is it?", .context = MakeText(size)}};
+}
+
+template <>
+TableQuestionAnswerArgs MakeArgs(std::size_t size) {
+  return {
+      .inputs = {.query = "How many?", .table = {{"Repository", MakeTexts(size / 2)}, {"Stars", MakeTexts(size / 2)}}},
+  };
+}
+
+template <>
+TextClassificationArgs MakeArgs(std::size_t size) {
+  return {.inputs = MakeText(size)};
+}
+
+template <>
+TextGenerationArgs MakeArgs(std::size_t size) {
+  return {.inputs = MakeText(size), .parameters_opt = TextGenerationArgs::Parameters{.max_new_tokens_opt = 50}};
+}
+
+template <>
+TokenClassificationArgs MakeArgs(std::size_t size) {
+  return {.inputs = MakeText(size), .parameters_opt = TokenClassificationArgs::Parameters{}};
+}
+
+template <>
+TranslationArgs MakeArgs(std::size_t size) {
+  return {.inputs = MakeText(size)};
+}
+
+template <>
+ZeroShotClassificationArgs MakeArgs(std::size_t size) {
+  return {
+      .inputs = MakeTexts(size),
+      .parameters_opt = ZeroShotClassificationArgs::Parameters{.candidate_labels = {"refund", "legal", "faq"}},
+  };
+}
+
+template <>
+ConversationalArgs MakeArgs(std::size_t size) {
+  return {
+      .inputs = {.past_user_inputs = MakeTexts(size / 2), .generated_responses = MakeTexts(size / 2), .text = "Why?"},
+      .parameters_opt = ConversationalArgs::Parameters{},
+  };
+}
+
+template <>
+TextToImageArgs MakeArgs(std::size_t size) {
+  return {.inputs = MakeText(size), .negative_prompt_opt = "blurry"};
+}
+
+template <>
+BatchArgs<TextClassificationArgs> MakeArgs(std::size_t size) {
+  return {.other_args = {}, .inputs = MakeTexts(size)};
+}
+
+template <typename T, std::string (*MakeBody)(const T&, const ExtendedOptions&)>
+void BM_MakeBody(benchmark::State& state) {
+  const T other_args = MakeArgs<T>(static_cast<std::size_t>(state.range(0)));
+  const ExtendedOptions extended_options(Options{});
+  if (MakeBodyFromJson(other_args, extended_options) != MakeBodyFromJsonTree(other_args, extended_options)) {
+    state.SkipWithError("MakeBodyFromJson() and MakeBodyFromJsonTree() differ.");
+    return;
+  }
+
+  const AllocationStats start_allocation_stats = allocation_stats;
+  std::size_t body_size = 0;
+  for (auto _ : state) {
+    std::string body = MakeBody(other_args, extended_options);
+    body_size = body.size();
+    benchmark::DoNotOptimize(body);
+  }
+
+  state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * body_size));
+  state.counters["allocs/op"] = benchmark::Counter(
+      static_cast<double>(allocation_stats.num_allocations - start_allocation_stats.num_allocations),
+      benchmark::Counter::kAvgIterations);
+  state.counters["alloc_bytes/op"] = benchmark::Counter(
+      static_cast<double>(allocation_stats.num_bytes - start_allocation_stats.num_bytes),
+      benchmark::Counter::kAvgIterations);
+  state.counters["body_bytes"] = static_cast<double>(body_size);
+}
+
+// Input sizes in bytes.
+void InputSizes(benchmark::internal::Benchmark* benchmark) {
+  benchmark->Arg(16)->Arg(1024)->Arg(64 * 1024);
+}
+
+template <typename T>
+void BM_MakeBodyFromJson(benchmark::State& state) {
+  BM_MakeBody<T, MakeBodyFromJson<T>>(state);
+}
+
+template <typename T>
+void BM_MakeBodyFromJsonTree(benchmark::State& state) {
+  BM_MakeBody<T, MakeBodyFromJsonTree<T>>(state);
+}
+
+BENCHMARK_TEMPLATE(BM_MakeBodyFromJson, FillMaskArgs)->Apply(InputSizes);
+BENCHMARK_TEMPLATE(BM_MakeBodyFromJsonTree, FillMaskArgs)->Apply(InputSizes);
+BENCHMARK_TEMPLATE(BM_MakeBodyFromJson, SummarizationArgs)->Apply(InputSizes);
+BENCHMARK_TEMPLATE(BM_MakeBodyFromJsonTree, SummarizationArgs)->Apply(InputSizes);
+BENCHMARK_TEMPLATE(BM_MakeBodyFromJson, QuestionAnswerArgs)->Apply(InputSizes);
+BENCHMARK_TEMPLATE(BM_MakeBodyFromJsonTree, QuestionAnswerArgs)->Apply(InputSizes);
+BENCHMARK_TEMPLATE(BM_MakeBodyFromJson, TableQuestionAnswerArgs)->Apply(InputSizes);
+BENCHMARK_TEMPLATE(BM_MakeBodyFromJsonTree, TableQuestionAnswerArgs)->Apply(InputSizes);
+BENCHMARK_TEMPLATE(BM_MakeBodyFromJson, TextClassificationArgs)->Apply(InputSizes);
+BENCHMARK_TEMPLATE(BM_MakeBodyFromJsonTree, TextClassificationArgs)->Apply(InputSizes);
+BENCHMARK_TEMPLATE(BM_MakeBodyFromJson, TextGenerationArgs)->Apply(InputSizes);
+BENCHMARK_TEMPLATE(BM_MakeBodyFromJsonTree, TextGenerationArgs)->Apply(InputSizes);
+BENCHMARK_TEMPLATE(BM_MakeBodyFromJson, TokenClassificationArgs)->Apply(InputSizes);
+BENCHMARK_TEMPLATE(BM_MakeBodyFromJsonTree, TokenClassificationArgs)->Apply(InputSizes);
+BENCHMARK_TEMPLATE(BM_MakeBodyFromJson, TranslationArgs)->Apply(InputSizes);
+BENCHMARK_TEMPLATE(BM_MakeBodyFromJsonTree, TranslationArgs)->Apply(InputSizes);
+BENCHMARK_TEMPLATE(BM_MakeBodyFromJson, ZeroShotClassificationArgs)->Apply(InputSizes);
+BENCHMARK_TEMPLATE(BM_MakeBodyFromJsonTree, ZeroShotClassificationArgs)->Apply(InputSizes);
+BENCHMARK_TEMPLATE(BM_MakeBodyFromJson, ConversationalArgs)->Apply(InputSizes);
+BENCHMARK_TEMPLATE(BM_MakeBodyFromJsonTree, ConversationalArgs)->Apply(InputSizes);
+BENCHMARK_TEMPLATE(BM_MakeBodyFromJson, TextToImageArgs)->Apply(InputSizes);
+BENCHMARK_TEMPLATE(BM_MakeBodyFromJsonTree, TextToImageArgs)->Apply(InputSizes);
+BENCHMARK_TEMPLATE(BM_MakeBodyFromJson, BatchArgs<TextClassificationArgs>)->Apply(InputSizes);
+BENCHMARK_TEMPLATE(BM_MakeBodyFromJsonTree, BatchArgs<TextClassificationArgs>)->Apply(InputSizes);
+
+BENCHMARK_MAIN();
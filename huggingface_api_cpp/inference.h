@@ -2,3 +2,4 @@
 
 // Header file aggregation for users.
 #include "huggingface_api_cpp/inference/hf_inference.h"
+#include "huggingface_api_cpp/inference/mask_decoder.h"
@@ -2,13 +2,18 @@
 
 #include <filesystem>
 #include <iostream>
+#include <map>
 #include <optional>
+#include <span>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <vector>
 
 #include <nlohmann/json.hpp>
 
+#include "huggingface_api_cpp/inference/json_writer.h"
+
 namespace huggingface_api_cpp::inference {
 
 struct Args {
@@ -29,6 +34,13 @@ void to_json(nlohmann::json& json, const FillMaskArgs& other_args) {
   };
 }
 
+template <>
+struct JsonSchema<FillMaskArgs> {
+  static constexpr std::tuple kFields = {
+    JsonField{"inputs", &FillMaskArgs::inputs},
+  };
+};
+
 struct SummarizationArgs {
   struct Parameters {
     std::optional<int> max_length_opt = std::nullopt;
@@ -70,6 +82,19 @@ void to_json(nlohmann::json& json, const SummarizationArgs::Parameters& paramete
   }
 }
 
+template <>
+struct JsonSchema<SummarizationArgs::Parameters> {
+  static constexpr std::tuple kFields = {
+    JsonField{"max_length", &SummarizationArgs::Parameters::max_length_opt},
+    JsonField{"max_time", &SummarizationArgs::Parameters::max_time_opt},
+    JsonField{"min_length", &SummarizationArgs::Parameters::min_length_opt},
+    JsonField{"repetition_penalty", &SummarizationArgs::Parameters::repetition_penalty_opt},
+    JsonField{"temperature", &SummarizationArgs::Parameters::temperature_opt},
+    JsonField{"top_k", &SummarizationArgs::Parameters::top_k_opt},
+    JsonField{"top_p", &SummarizationArgs::Parameters::top_p_opt},
+  };
+};
+
 void to_json(nlohmann::json& json, const SummarizationArgs& other_args) {
   json = nlohmann::json{
     {"inputs", other_args.inputs},
@@ -80,6 +105,14 @@ void to_json(nlohmann::json& json, const SummarizationArgs& other_args) {
   }
 }
 
+template <>
+struct JsonSchema<SummarizationArgs> {
+  static constexpr std::tuple kFields = {
+    JsonField{"inputs", &SummarizationArgs::inputs},
+    JsonField{"parameters", &SummarizationArgs::parameters_opt},
+  };
+};
+
 struct QuestionAnswerArgs {
   struct Inputs {
     std::string question = "";
@@ -96,12 +129,27 @@ void to_json(nlohmann::json& json, const QuestionAnswerArgs::Inputs& parameters)
   };
 }
 
+template <>
+struct JsonSchema<QuestionAnswerArgs::Inputs> {
+  static constexpr std::tuple kFields = {
+    JsonField{"context", &QuestionAnswerArgs::Inputs::context},
+    JsonField{"question", &QuestionAnswerArgs::Inputs::question},
+  };
+};
+
 void to_json(nlohmann::json& json, const QuestionAnswerArgs& other_args) {
   json = nlohmann::json{
     {"inputs", other_args.inputs},
   };
 }
 
+template <>
+struct JsonSchema<QuestionAnswerArgs> {
+  static constexpr std::tuple kFields = {
+    JsonField{"inputs", &QuestionAnswerArgs::inputs},
+  };
+};
+
 struct TableQuestionAnswerArgs {
   struct Inputs {
     std::string query = "";
@@ -118,12 +166,27 @@ void to_json(nlohmann::json& json, const TableQuestionAnswerArgs::Inputs& parame
   };
 }
 
+template <>
+struct JsonSchema<TableQuestionAnswerArgs::Inputs> {
+  static constexpr std::tuple kFields = {
+    JsonField{"query", &TableQuestionAnswerArgs::Inputs::query},
+    JsonField{"table", &TableQuestionAnswerArgs::Inputs::table},
+  };
+};
+
 void to_json(nlohmann::json& json, const TableQuestionAnswerArgs& other_args) {
   json = nlohmann::json{
     {"inputs", other_args.inputs},
   };
 }
 
+template <>
+struct JsonSchema<TableQuestionAnswerArgs> {
+  static constexpr std::tuple kFields = {
+    JsonField{"inputs", &TableQuestionAnswerArgs::inputs},
+  };
+};
+
 struct TextClassificationArgs {
   std::string inputs = "";
 };
@@ -134,6 +197,13 @@ void to_json(nlohmann::json& json, const TextClassificationArgs& other_args) {
   };
 }
 
+template <>
+struct JsonSchema<TextClassificationArgs> {
+  static constexpr std::tuple kFields = {
+    JsonField{"inputs", &TextClassificationArgs::inputs},
+  };
+};
+
 struct TextGenerationArgs {
   struct Parameters {
     std::optional<bool> do_sample_opt = true;
@@ -183,6 +253,21 @@ void to_json(nlohmann::json& json, const TextGenerationArgs::Parameters& paramet
   }
 }
 
+template <>
+struct JsonSchema<TextGenerationArgs::Parameters> {
+  static constexpr std::tuple kFields = {
+    JsonField{"do_sample", &TextGenerationArgs::Parameters::do_sample_opt},
+    JsonField{"max_new_tokens", &TextGenerationArgs::Parameters::max_new_tokens_opt},
+    JsonField{"max_time", &TextGenerationArgs::Parameters::max_time_opt},
+    JsonField{"num_return_sequences", &TextGenerationArgs::Parameters::num_return_sequences_opt},
+    JsonField{"repetition_penalty", &TextGenerationArgs::Parameters::repetition_penalty_opt},
+    JsonField{"return_full_text", &TextGenerationArgs::Parameters::return_full_text_opt},
+    JsonField{"temperature", &TextGenerationArgs::Parameters::temperature_opt},
+    JsonField{"top_k", &TextGenerationArgs::Parameters::top_k_opt},
+    JsonField{"top_p", &TextGenerationArgs::Parameters::top_p_opt},
+  };
+};
+
 void to_json(nlohmann::json& json, const TextGenerationArgs& other_args) {
   json = nlohmann::json{
     {"inputs", other_args.inputs},
@@ -193,6 +278,14 @@ void to_json(nlohmann::json& json, const TextGenerationArgs& other_args) {
   }
 }
 
+template <>
+struct JsonSchema<TextGenerationArgs> {
+  static constexpr std::tuple kFields = {
+    JsonField{"inputs", &TextGenerationArgs::inputs},
+    JsonField{"parameters", &TextGenerationArgs::parameters_opt},
+  };
+};
+
 struct TokenClassificationArgs {
   struct Parameters {
     enum class AggregationStrategy {
@@ -203,14 +296,15 @@ struct TokenClassificationArgs {
       kMax,
     };
 
-    static std::map<AggregationStrategy, std::string> AggregationStrategyMapper() {
-      return {
+    static const std::map<AggregationStrategy, std::string>& AggregationStrategyMapper() {
+      static const std::map<AggregationStrategy, std::string> aggregation_strategy_mapper = {
         {AggregationStrategy::kNone, "none"},
         {AggregationStrategy::kSimple, "simple"},
         {AggregationStrategy::kFirst, "first"},
         {AggregationStrategy::kAverage, "average"},
         {AggregationStrategy::kMax, "max"},
       };
+      return aggregation_strategy_mapper;
     }
 
     std::optional<AggregationStrategy> aggregation_strategy_opt = AggregationStrategy::kSimple;
@@ -224,11 +318,25 @@ void to_json(nlohmann::json& json, const TokenClassificationArgs::Parameters& pa
   json = nlohmann::json{};
 
   if (parameters.aggregation_strategy_opt.has_value()) {
-    const auto aggregation_strategy_mapper = TokenClassificationArgs::Parameters::AggregationStrategyMapper();
+    const auto& aggregation_strategy_mapper = TokenClassificationArgs::Parameters::AggregationStrategyMapper();
     json["aggregation_strategy"] = aggregation_strategy_mapper.at(parameters.aggregation_strategy_opt.value());
   }
 }
 
+template <>
+struct JsonSchema<TokenClassificationArgs::Parameters::AggregationStrategy> {
+  static const std::string& name(TokenClassificationArgs::Parameters::AggregationStrategy aggregation_strategy) {
+    return TokenClassificationArgs::Parameters::AggregationStrategyMapper().at(aggregation_strategy);
+  }
+};
+
+template <>
+struct JsonSchema<TokenClassificationArgs::Parameters> {
+  static constexpr std::tuple kFields = {
+    JsonField{"aggregation_strategy", &TokenClassificationArgs::Parameters::aggregation_strategy_opt},
+  };
+};
+
 void to_json(nlohmann::json& json, const TokenClassificationArgs& other_args) {
   json = nlohmann::json{
     {"inputs", other_args.inputs},
@@ -239,6 +347,14 @@ void to_json(nlohmann::json& json, const TokenClassificationArgs& other_args) {
   }
 }
 
+template <>
+struct JsonSchema<TokenClassificationArgs> {
+  static constexpr std::tuple kFields = {
+    JsonField{"inputs", &TokenClassificationArgs::inputs},
+    JsonField{"parameters", &TokenClassificationArgs::parameters_opt},
+  };
+};
+
 struct TranslationArgs {
   std::string inputs = "";
 };
@@ -249,6 +365,13 @@ void to_json(nlohmann::json& json, const TranslationArgs& other_args) {
   };
 }
 
+template <>
+struct JsonSchema<TranslationArgs> {
+  static constexpr std::tuple kFields = {
+    JsonField{"inputs", &TranslationArgs::inputs},
+  };
+};
+
 struct ZeroShotClassificationArgs {
   struct Parameters {
     std::vector<std::string> candidate_labels = {};
@@ -269,6 +392,14 @@ void to_json(nlohmann::json& json, const ZeroShotClassificationArgs::Parameters&
   }
 }
 
+template <>
+struct JsonSchema<ZeroShotClassificationArgs::Parameters> {
+  static constexpr std::tuple kFields = {
+    JsonField{"candidate_labels", &ZeroShotClassificationArgs::Parameters::candidate_labels},
+    JsonField{"multi_label", &ZeroShotClassificationArgs::Parameters::multi_label_opt},
+  };
+};
+
 void to_json(nlohmann::json& json, const ZeroShotClassificationArgs& other_args) {
   json = nlohmann::json{
     {"inputs", other_args.inputs},
@@ -279,6 +410,14 @@ void to_json(nlohmann::json& json, const ZeroShotClassificationArgs& other_args)
   }
 }
 
+template <>
+struct JsonSchema<ZeroShotClassificationArgs> {
+  static constexpr std::tuple kFields = {
+    JsonField{"inputs", &ZeroShotClassificationArgs::inputs},
+    JsonField{"parameters", &ZeroShotClassificationArgs::parameters_opt},
+  };
+};
+
 struct ConversationalArgs {
   struct Inputs {
     std::vector<std::string> past_user_inputs = {};
@@ -308,6 +447,15 @@ void to_json(nlohmann::json& json, const ConversationalArgs::Inputs& parameters)
   };
 }
 
+template <>
+struct JsonSchema<ConversationalArgs::Inputs> {
+  static constexpr std::tuple kFields = {
+    JsonField{"generated_responses", &ConversationalArgs::Inputs::generated_responses},
+    JsonField{"past_user_inputs", &ConversationalArgs::Inputs::past_user_inputs},
+    JsonField{"text", &ConversationalArgs::Inputs::text},
+  };
+};
+
 void to_json(nlohmann::json& json, const ConversationalArgs::Parameters& parameters) {
   json = nlohmann::json{};
 
@@ -334,6 +482,19 @@ void to_json(nlohmann::json& json, const ConversationalArgs::Parameters& paramet
   }
 }
 
+template <>
+struct JsonSchema<ConversationalArgs::Parameters> {
+  static constexpr std::tuple kFields = {
+    JsonField{"max_length", &ConversationalArgs::Parameters::max_length_opt},
+    JsonField{"max_time", &ConversationalArgs::Parameters::max_time_opt},
+    JsonField{"min_length", &ConversationalArgs::Parameters::min_length_opt},
+    JsonField{"repetition_penalty", &ConversationalArgs::Parameters::repetition_penalty_opt},
+    JsonField{"temperature", &ConversationalArgs::Parameters::temperature_opt},
+    JsonField{"top_k", &ConversationalArgs::Parameters::top_k_opt},
+    JsonField{"top_p", &ConversationalArgs::Parameters::top_p_opt},
+  };
+};
+
 void to_json(nlohmann::json& json, const ConversationalArgs& other_args) {
   json = nlohmann::json{
     {"inputs", other_args.inputs},
@@ -344,12 +505,34 @@ void to_json(nlohmann::json& json, const ConversationalArgs& other_args) {
   }
 }
 
+template <>
+struct JsonSchema<ConversationalArgs> {
+  static constexpr std::tuple kFields = {
+    JsonField{"inputs", &ConversationalArgs::inputs},
+    JsonField{"parameters", &ConversationalArgs::parameters_opt},
+  };
+};
+
+// Sends several `inputs` in one request, with the other fields (e.g. `parameters`) taken from `other_args`.
+template <typename T>
+struct BatchArgs {
+  T other_args;
+  std::vector<std::string> inputs = {};
+};
+
+template <typename T>
+void to_json(nlohmann::json& json, const BatchArgs<T>& batch_args) {
+  json = batch_args.other_args;
+  json["inputs"] = batch_args.inputs;
+}
+
 //////////////////////
 // Audio Processing //
 //////////////////////
 
 struct AutomaticSpeechRecognitionArgs {
   std::filesystem::path data;
+  std::span<const char> data_buffer = {};  // If not empty, sent instead of `data`. Must outlive the call.
 };
 
 void to_json(nlohmann::json& json, const AutomaticSpeechRecognitionArgs& other_args) {
@@ -359,6 +542,7 @@ void to_json(nlohmann::json& json, const AutomaticSpeechRecognitionArgs& other_a
 
 struct AudioClassificationArgs {
   std::filesystem::path data;
+  std::span<const char> data_buffer = {};  // If not empty, sent instead of `data`. Must outlive the call.
 };
 
 void to_json(nlohmann::json& json, const AudioClassificationArgs& other_args) {
@@ -372,6 +556,7 @@ void to_json(nlohmann::json& json, const AudioClassificationArgs& other_args) {
 
 struct ImageClassificationArgs {
   std::filesystem::path data;
+  std::span<const char> data_buffer = {};  // If not empty, sent instead of `data`. Must outlive the call.
 };
 
 void to_json(nlohmann::json& json, const ImageClassificationArgs& other_args) {
@@ -381,6 +566,7 @@ void to_json(nlohmann::json& json, const ImageClassificationArgs& other_args) {
 
 struct ObjectDetectionArgs {
   std::filesystem::path data;
+  std::span<const char> data_buffer = {};  // If not empty, sent instead of `data`. Must outlive the call.
 };
 
 void to_json(nlohmann::json& json, const ObjectDetectionArgs& other_args) {
@@ -390,6 +576,7 @@ void to_json(nlohmann::json& json, const ObjectDetectionArgs& other_args) {
 
 struct ImageSegmentationArgs {
   std::filesystem::path data;
+  std::span<const char> data_buffer = {};  // If not empty, sent instead of `data`. Must outlive the call.
 };
 
 void to_json(nlohmann::json& json, const ImageSegmentationArgs& other_args) {
@@ -412,4 +599,52 @@ void to_json(nlohmann::json& json, const TextToImageArgs& other_args) {
   }
 }
 
+template <>
+struct JsonSchema<TextToImageArgs> {
+  static constexpr std::tuple kFields = {
+    JsonField{"inputs", &TextToImageArgs::inputs},
+    JsonField{"negative_prompt", &TextToImageArgs::negative_prompt_opt},
+  };
+};
+
+// The task of each argument type, as named on the Hub, e.g. "text-classification". Labels the metrics of the calls.
+template <typename T>
+inline constexpr std::string_view kTaskName = "unknown";
+
+template <>
+inline constexpr std::string_view kTaskName<FillMaskArgs> = "fill-mask";
+template <>
+inline constexpr std::string_view kTaskName<SummarizationArgs> = "summarization";
+template <>
+inline constexpr std::string_view kTaskName<QuestionAnswerArgs> = "question-answering";
+template <>
+inline constexpr std::string_view kTaskName<TableQuestionAnswerArgs> = "table-question-answering";
+template <>
+inline constexpr std::string_view kTaskName<TextClassificationArgs> = "text-classification";
+template <>
+inline constexpr std::string_view kTaskName<TextGenerationArgs> = "text-generation";
+template <>
+inline constexpr std::string_view kTaskName<TokenClassificationArgs> = "token-classification";
+template <>
+inline constexpr std::string_view kTaskName<TranslationArgs> = "translation";
+template <>
+inline constexpr std::string_view kTaskName<ZeroShotClassificationArgs> = "zero-shot-classification";
+template <>
+inline constexpr std::string_view kTaskName<ConversationalArgs> = "conversational";
+template <>
+inline constexpr std::string_view kTaskName<AutomaticSpeechRecognitionArgs> = "automatic-speech-recognition";
+template <>
+inline constexpr std::string_view kTaskName<AudioClassificationArgs> = "audio-classification";
+template <>
+inline constexpr std::string_view kTaskName<ImageClassificationArgs> = "image-classification";
+template <>
+inline constexpr std::string_view kTaskName<ObjectDetectionArgs> = "object-detection";
+template <>
+inline constexpr std::string_view kTaskName<ImageSegmentationArgs> = "image-segmentation";
+template <>
+inline constexpr std::string_view kTaskName<TextToImageArgs> = "text-to-image";
+
+template <typename T>
+inline constexpr std::string_view kTaskName<BatchArgs<T>> = kTaskName<T>;
+
 }  // namespace huggingface_api_cpp::inference
@@ -0,0 +1,212 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string_view>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define HUGGINGFACE_API_CPP_X86_SIMD 1
+#include <immintrin.h>
+#endif
+
+namespace huggingface_api_cpp::inference {
+
+// The implementations of `DecodeBase64()`. The vector ones decode the bulk of the input, and fall back to the scalar
+// one for the tail and for anything that is not a base64 character (e.g. the padding).
+enum class Base64Decoder {
+  kScalar,
+  kSse,   // SSSE3 and SSE4.1, 16 characters per step.
+  kAvx2,  // 32 characters per step.
+};
+
+// The number of bytes `encoded` decodes into, assuming that it is valid padded base64.
+inline std::size_t Base64DecodedSize(std::string_view encoded) {
+  std::size_t size = encoded.size() / 4 * 3;
+  if (!encoded.empty() && encoded.back() == '=') {
+    --size;
+    if (2 <= encoded.size() && encoded[encoded.size() - 2] == '=') {
+      --size;
+    }
+  }
+  return size;
+}
+
+namespace base64_internal {
+
+// The 6-bit value of each base64 character, or -1.
+inline constexpr std::array<std::int8_t, 256> kValues = [] {
+  std::array<std::int8_t, 256> values{};
+  values.fill(-1);
+  constexpr std::string_view kAlphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+  for (std::size_t i = 0; i < kAlphabet.size(); ++i) {
+    values[static_cast<unsigned char>(kAlphabet[i])] = static_cast<std::int8_t>(i);
+  }
+  return values;
+}();
+
+// Decodes the characters in `[in, in_end)`, whose count is a multiple of 4, into `out`. Returns the end of the output,
+// or nullptr if the input is invalid. Padding is only allowed in the last quantum.
+inline char* DecodeScalar(const char* in, const char* in_end, char* out) {
+  while (in != in_end) {
+    const std::int8_t a = kValues[static_cast<unsigned char>(in[0])];
+    const std::int8_t b = kValues[static_cast<unsigned char>(in[1])];
+    const std::int8_t c = kValues[static_cast<unsigned char>(in[2])];
+    const std::int8_t d = kValues[static_cast<unsigned char>(in[3])];
+    in += 4;
+    if ((a | b | c | d) < 0) {
+      // Only "xx==" and "xxx=" at the very end are valid.
+      const bool is_last = (in == in_end);
+      if (!is_last || a < 0 || b < 0 || in[-1] != '=' || (c < 0 && in[-2] != '=')) {
+        return nullptr;
+      }
+      *out++ = static_cast<char>((a << 2) | (b >> 4));
+      if (0 <= c) {
+        *out++ = static_cast<char>((b << 4) | (c >> 2));
+      }
+      return out;
+    }
+    *out++ = static_cast<char>((a << 2) | (b >> 4));
+    *out++ = static_cast<char>((b << 4) | (c >> 2));
+    *out++ = static_cast<char>((c << 6) | d);
+  }
+  return out;
+}
+
+#ifdef HUGGINGFACE_API_CPP_X86_SIMD
+
+// The vector decoders follow W. Muła and D. Lemire, "Faster Base64 Encoding and Decoding Using AVX2 Instructions"
+// (2018): the characters are validated and translated to 6-bit values with nibble lookups, then packed with
+// multiply-adds. Each step stores a whole register but advances by 3/4 of it, so the loops stop while there is room
+// for that overhang, and on the first invalid character. They return how far they got.
+
+__attribute__((target("ssse3,sse4.1")))
+inline void DecodeSse(const char*& in, const char* in_end, char*& out, const char* out_end) {
+  const __m128i lut_lo = _mm_setr_epi8(0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+                                       0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A);
+  const __m128i lut_hi = _mm_setr_epi8(0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+                                       0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+  const __m128i lut_roll = _mm_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+  const __m128i mask_2f = _mm_set1_epi8(0x2F);
+  const __m128i pack_shuffle = _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+
+  while (16 <= in_end - in && 16 <= out_end - out) {
+    __m128i str = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in));
+    const __m128i hi_nibbles = _mm_and_si128(_mm_srli_epi32(str, 4), mask_2f);
+    const __m128i lo_nibbles = _mm_and_si128(str, mask_2f);
+    const __m128i hi = _mm_shuffle_epi8(lut_hi, hi_nibbles);
+    const __m128i lo = _mm_shuffle_epi8(lut_lo, lo_nibbles);
+    if (!_mm_testz_si128(lo, hi)) {
+      return;
+    }
+    const __m128i eq_2f = _mm_cmpeq_epi8(str, mask_2f);
+    const __m128i roll = _mm_shuffle_epi8(lut_roll, _mm_add_epi8(eq_2f, hi_nibbles));
+    str = _mm_add_epi8(str, roll);
+
+    const __m128i merged = _mm_maddubs_epi16(str, _mm_set1_epi32(0x01400140));
+    const __m128i packed = _mm_madd_epi16(merged, _mm_set1_epi32(0x00011000));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm_shuffle_epi8(packed, pack_shuffle));
+    in += 16;
+    out += 12;
+  }
+}
+
+__attribute__((target("avx2")))
+inline void DecodeAvx2(const char*& in, const char* in_end, char*& out, const char* out_end) {
+  const __m256i lut_lo = _mm256_setr_epi8(0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+                                          0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A,
+                                          0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+                                          0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A);
+  const __m256i lut_hi = _mm256_setr_epi8(0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+                                          0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+                                          0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+                                          0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+  const __m256i lut_roll = _mm256_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0,
+                                            0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+  const __m256i mask_2f = _mm256_set1_epi8(0x2F);
+  const __m256i pack_shuffle = _mm256_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+                                                2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+  const __m256i pack_permute = _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 3, 7);
+
+  while (32 <= in_end - in && 32 <= out_end - out) {
+    __m256i str = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in));
+    const __m256i hi_nibbles = _mm256_and_si256(_mm256_srli_epi32(str, 4), mask_2f);
+    const __m256i lo_nibbles = _mm256_and_si256(str, mask_2f);
+    const __m256i hi = _mm256_shuffle_epi8(lut_hi, hi_nibbles);
+    const __m256i lo = _mm256_shuffle_epi8(lut_lo, lo_nibbles);
+    if (!_mm256_testz_si256(lo, hi)) {
+      return;
+    }
+    const __m256i eq_2f = _mm256_cmpeq_epi8(str, mask_2f);
+    const __m256i roll = _mm256_shuffle_epi8(lut_roll, _mm256_add_epi8(eq_2f, hi_nibbles));
+    str = _mm256_add_epi8(str, roll);
+
+    const __m256i merged = _mm256_maddubs_epi16(str, _mm256_set1_epi32(0x01400140));
+    __m256i packed = _mm256_madd_epi16(merged, _mm256_set1_epi32(0x00011000));
+    packed = _mm256_shuffle_epi8(packed, pack_shuffle);
+    packed = _mm256_permutevar8x32_epi32(packed, pack_permute);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), packed);
+    in += 32;
+    out += 24;
+  }
+}
+
+#endif  // HUGGINGFACE_API_CPP_X86_SIMD
+
+}  // namespace base64_internal
+
+inline bool IsSupported(Base64Decoder decoder) {
+  switch (decoder) {
+    case Base64Decoder::kScalar:
+      return true;
+#ifdef HUGGINGFACE_API_CPP_X86_SIMD
+    case Base64Decoder::kSse:
+      return __builtin_cpu_supports("ssse3") && __builtin_cpu_supports("sse4.1");
+    case Base64Decoder::kAvx2:
+      return __builtin_cpu_supports("avx2");
+#endif
+    default:
+      return false;
+  }
+}
+
+// The fastest implementation supported by the CPU, detected once.
+inline Base64Decoder BestBase64Decoder() {
+  static const Base64Decoder kBestDecoder = IsSupported(Base64Decoder::kAvx2) ? Base64Decoder::kAvx2
+                                            : IsSupported(Base64Decoder::kSse) ? Base64Decoder::kSse
+                                                                               : Base64Decoder::kScalar;
+  return kBestDecoder;
+}
+
+// Decodes padded base64 (RFC 4648, without line breaks) into the caller-provided `output`, which needs
+// `Base64DecodedSize(encoded)` bytes. Returns the number of bytes written, or std::nullopt if `encoded` is invalid or
+// `output` is too small. `decoder` must be supported by the CPU.
+inline std::optional<std::size_t> DecodeBase64(std::string_view encoded, std::span<char> output,
+                                               Base64Decoder decoder = BestBase64Decoder()) {
+  if (encoded.size() % 4 != 0 || output.size() < Base64DecodedSize(encoded)) {
+    return std::nullopt;
+  }
+
+  const char* in = encoded.data();
+  const char* in_end = in + encoded.size();
+  char* out = output.data();
+  [[maybe_unused]] const char* out_end = out + output.size();
+#ifdef HUGGINGFACE_API_CPP_X86_SIMD
+  if (decoder == Base64Decoder::kAvx2) {
+    base64_internal::DecodeAvx2(in, in_end, out, out_end);
+  }
+  if (decoder == Base64Decoder::kAvx2 || decoder == Base64Decoder::kSse) {
+    base64_internal::DecodeSse(in, in_end, out, out_end);
+  }
+#endif
+
+  out = base64_internal::DecodeScalar(in, in_end, out);
+  if (out == nullptr) {
+    return std::nullopt;
+  }
+  return static_cast<std::size_t>(out - output.data());
+}
+
+}  // namespace huggingface_api_cpp::inference
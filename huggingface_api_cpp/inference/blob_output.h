@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <string>
+
+namespace huggingface_api_cpp::inference {
+
+// Receives a blob output, e.g. the image generated by `textToImage()`, chunk by chunk as it arrives.
+using BlobSink = std::function<void(const char* data, std::size_t size)>;
+
+// The result of a call whose blob output is returned in memory or streamed to a `BlobSink`.
+struct BlobOutput {
+  long response_code = 0;  // 0 if the transfer failed, e.g. on a connection error or an exception thrown by a sink.
+
+  // The blob bytes if `response_code` is 200, except when they were streamed to a sink. Otherwise, the error body
+  // returned by the server, or the error JSON of the library (e.g. `{"curlpp_runtime_error": ...}`).
+  std::string data;
+};
+
+}  // namespace huggingface_api_cpp::inference
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace huggingface_api_cpp::inference {
+
+struct BufferPoolConfig {
+  std::size_t max_idle_buffers = 64;              // Released buffers beyond this are freed.
+  std::size_t max_buffer_capacity = 1024 * 1024;  // Released buffers larger than this are freed.
+};
+
+struct BufferPoolStats {
+  std::uint64_t hits = 0;      // Acquisitions served by an idle buffer.
+  std::uint64_t misses = 0;    // Acquisitions that started from an empty buffer.
+  std::uint64_t discards = 0;  // Released buffers freed for exceeding the limits.
+};
+
+// A thread-safe pool of string buffers that keep their capacity between requests, so that a request body of the
+// usual size is written without allocating.
+class BufferPool : public std::enable_shared_from_this<BufferPool> {
+ public:
+  // Owns a pooled buffer, and returns it to the pool on destruction. An empty handle has no buffer.
+  class Handle {
+   public:
+    Handle() = default;
+
+    Handle(std::shared_ptr<BufferPool> pool, std::string buffer)
+        : pool_(std::move(pool)), buffer_(std::move(buffer)) {}
+
+    Handle(Handle&& other) = default;
+
+    Handle& operator=(Handle&& other) {
+      if (this != &other) {
+        reset();
+        pool_ = std::move(other.pool_);
+        buffer_ = std::move(other.buffer_);
+      }
+      return *this;
+    }
+
+    ~Handle() {
+      reset();
+    }
+
+    explicit operator bool() const {
+      return pool_ != nullptr;
+    }
+
+    std::string& str() {
+      return buffer_;
+    }
+
+    const std::string& str() const {
+      return buffer_;
+    }
+
+   private:
+    void reset() {
+      if (pool_) {
+        std::exchange(pool_, nullptr)->release(std::move(buffer_));
+      }
+    }
+
+    std::shared_ptr<BufferPool> pool_;
+    std::string buffer_;
+  };
+
+  // Must be owned by a `std::shared_ptr`, which the handles share.
+  BufferPool(const BufferPoolConfig& config = BufferPoolConfig()) : config_(config) {}
+
+  BufferPool(const BufferPool&) = delete;
+  BufferPool& operator=(const BufferPool&) = delete;
+
+  // Returns an empty buffer, with the capacity of a released one if any.
+  Handle acquire() {
+    std::string buffer;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (idle_buffers_.empty()) {
+        ++stats_.misses;
+      } else {
+        // LIFO, since the most recently used buffer is the most likely to be in the cache.
+        buffer = std::move(idle_buffers_.back());
+        idle_buffers_.pop_back();
+        ++stats_.hits;
+      }
+    }
+    return Handle(shared_from_this(), std::move(buffer));
+  }
+
+  BufferPoolStats stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+  }
+
+ private:
+  void release(std::string buffer) {
+    buffer.clear();
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (buffer.capacity() == 0) {
+      return;
+    }
+    if (config_.max_idle_buffers <= idle_buffers_.size() || config_.max_buffer_capacity < buffer.capacity()) {
+      ++stats_.discards;
+      return;
+    }
+    idle_buffers_.push_back(std::move(buffer));
+  }
+
+  const BufferPoolConfig config_;
+
+  mutable std::mutex mutex_;
+  std::vector<std::string> idle_buffers_;
+  BufferPoolStats stats_;
+};
+
+}  // namespace huggingface_api_cpp::inference
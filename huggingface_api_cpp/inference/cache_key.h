@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+
+namespace huggingface_api_cpp::inference {
+
+// Identifies a response by the URL of the model and the serialized request body.
+// `hash` is stable across processes (64-bit FNV-1a), so it can also index an on-disk cache. `check` is an
+// independent 64-bit digest used to reject `hash` collisions without storing the whole body.
+struct CacheKey {
+  std::uint64_t hash = 0;
+  std::uint64_t check = 0;
+
+  bool operator==(const CacheKey& other) const = default;
+};
+
+inline std::uint64_t Fnv1a64(std::string_view data, std::uint64_t seed = 14695981039346656037ull) {
+  std::uint64_t hash = seed;
+  for (const char c : data) {
+    hash ^= static_cast<unsigned char>(c);
+    hash *= 1099511628211ull;
+  }
+  return hash;
+}
+
+// Mixes the length in and finalizes with the SplitMix64 avalanche, which is independent enough from FNV-1a.
+inline std::uint64_t Mix64(std::uint64_t x) {
+  x += 0x9e3779b97f4a7c15ull;
+  x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+  x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+  return x ^ (x >> 31);
+}
+
+inline CacheKey MakeCacheKey(std::string_view url, std::string_view body) {
+  CacheKey cache_key;
+  cache_key.hash = Fnv1a64(body, Fnv1a64(url) ^ url.size());
+
+  std::uint64_t check = Mix64(body.size());
+  for (std::size_t i = 0; i < body.size(); i += sizeof(std::uint64_t)) {
+    std::uint64_t word = 0;
+    for (std::size_t j = 0; j < sizeof(std::uint64_t) && i + j < body.size(); ++j) {
+      word |= static_cast<std::uint64_t>(static_cast<unsigned char>(body[i + j])) << (8 * j);
+    }
+    check = Mix64(check ^ word);
+  }
+  cache_key.check = Mix64(check ^ Fnv1a64(url, 0x84222325cbf29ce4ull));
+
+  return cache_key;
+}
+
+}  // namespace huggingface_api_cpp::inference
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+#include <zlib.h>
+
+namespace huggingface_api_cpp::inference {
+
+enum class ContentEncoding {
+  kIdentity,
+  kGzip,
+  kDeflate,  // The zlib format, which is what HTTP calls deflate.
+};
+
+// The compression of the bodies of a call. The response bodies are decoded by libcurl, so they may be encoded with any
+// of the encodings libcurl was built with: gzip and deflate, and br and zstd if available. The request bodies are
+// compressed with zlib, which libcurl depends on anyway.
+struct CompressionPolicy {
+  // Sends Accept-Encoding with every encoding libcurl decodes, and decodes the response body before it reaches the
+  // output. Not applied to streamed responses, whose events a compressing server may hold back.
+  bool accept_encoded_responses = true;
+
+  // Compresses the JSON request bodies of at least `min_request_bytes`, and sends them with Content-Encoding. Only for
+  // a server that decodes request bodies. Binary inputs, which are usually compressed media, are sent as is.
+  ContentEncoding request_encoding = ContentEncoding::kIdentity;
+  std::size_t min_request_bytes = 16 * 1024;
+  int level = 1;  // From 1 (fastest) to 9 (smallest).
+};
+
+inline std::string_view ContentEncodingName(ContentEncoding content_encoding) {
+  switch (content_encoding) {
+    case ContentEncoding::kGzip:
+      return "gzip";
+    case ContentEncoding::kDeflate:
+      return "deflate";
+    default:
+      return "identity";
+  }
+}
+
+namespace compression_internal {
+
+// A zlib stream kept by each thread and reset between bodies, since initializing one allocates about 256 KiB.
+class Deflater {
+ public:
+  Deflater() = default;
+
+  Deflater(const Deflater&) = delete;
+  Deflater& operator=(const Deflater&) = delete;
+
+  ~Deflater() {
+    end();
+  }
+
+  // Compresses `data` into `output`, replacing its content. Returns false if zlib fails.
+  bool compress(std::string_view data, ContentEncoding content_encoding, int level, std::string& output) {
+    if (!prepare(content_encoding, level)) {
+      return false;
+    }
+
+    output.resize(deflateBound(&stream_, data.size()));
+    stream_.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+    stream_.next_out = reinterpret_cast<Bytef*>(output.data());
+    // zlib counts in `uInt`, so a large body is fed in chunks.
+    constexpr std::size_t kMaxChunkSize = 1u << 30;
+    std::size_t input_left = data.size();
+    std::size_t output_left = output.size();
+    int result = Z_OK;
+    while (result == Z_OK) {
+      stream_.avail_in = static_cast<uInt>(std::min(input_left, kMaxChunkSize));
+      stream_.avail_out = static_cast<uInt>(std::min(output_left, kMaxChunkSize));
+      const uInt avail_in = stream_.avail_in;
+      const uInt avail_out = stream_.avail_out;
+      result = deflate(&stream_, input_left == avail_in ? Z_FINISH : Z_NO_FLUSH);
+      input_left -= avail_in - stream_.avail_in;
+      output_left -= avail_out - stream_.avail_out;
+    }
+    output.resize(output.size() - output_left);
+    return result == Z_STREAM_END;
+  }
+
+ private:
+  bool prepare(ContentEncoding content_encoding, int level) {
+    if (is_initialized_ && content_encoding == content_encoding_ && level == level_) {
+      return deflateReset(&stream_) == Z_OK;
+    }
+    end();
+    // 16 more window bits ask for the gzip wrapper instead of the zlib one.
+    const int window_bits = content_encoding == ContentEncoding::kGzip ? 16 + MAX_WBITS : MAX_WBITS;
+    stream_ = z_stream{};
+    is_initialized_ = deflateInit2(&stream_, level, Z_DEFLATED, window_bits, 8, Z_DEFAULT_STRATEGY) == Z_OK;
+    content_encoding_ = content_encoding;
+    level_ = level;
+    return is_initialized_;
+  }
+
+  void end() {
+    if (is_initialized_) {
+      deflateEnd(&stream_);
+      is_initialized_ = false;
+    }
+  }
+
+  z_stream stream_{};
+  bool is_initialized_ = false;
+  ContentEncoding content_encoding_ = ContentEncoding::kIdentity;
+  int level_ = 0;
+};
+
+}  // namespace compression_internal
+
+// Compresses `data` with `content_encoding` into `output`, replacing its content, e.g. a pooled buffer that keeps its
+// capacity. Returns false if the encoding is identity or zlib fails, in which case the body is to be sent as is.
+inline bool CompressBody(std::string_view data, ContentEncoding content_encoding, int level, std::string& output) {
+  if (content_encoding == ContentEncoding::kIdentity) {
+    return false;
+  }
+  thread_local compression_internal::Deflater deflater;
+  return deflater.compress(data, content_encoding, level, output);
+}
+
+}  // namespace huggingface_api_cpp::inference
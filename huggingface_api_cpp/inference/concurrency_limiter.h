@@ -0,0 +1,166 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace huggingface_api_cpp::inference {
+
+struct ConcurrencyLimiterConfig {
+  double initial_limit = 16.0;
+  double min_limit = 1.0;
+  double max_limit = 512.0;
+
+  // A latency up to `tolerance` times the minimum latency is not taken as queueing at the server.
+  double tolerance = 1.2;
+  double smoothing = 0.2;     // Weight of each new estimate of the limit.
+  double backoff_ratio = 0.9;  // Applied to the limit on each overload response (429, 503 or 504).
+
+  // The minimum latency is measured again after this period, so that it follows changes of the model load.
+  std::chrono::seconds min_latency_window = std::chrono::seconds(30);
+};
+
+struct ConcurrencyLimiterStats {
+  double limit = 0.0;
+  std::size_t in_flight = 0;
+  std::size_t queue_depth = 0;  // Calls waiting for a slot.
+  std::chrono::microseconds min_latency = std::chrono::microseconds(0);
+};
+
+// Limits the number of in-flight requests per model, and adapts the limit to the latencies measured around each
+// transfer, so that the client finds the highest concurrency at which the server does not queue by itself.
+// The limit follows the gradient algorithm: it shrinks in proportion to `min_latency / latency` when the latency
+// rises above `tolerance` times its minimum, and grows by about its square root otherwise, while the calls fill it.
+class ConcurrencyLimiter {
+ public:
+  using Clock = std::chrono::steady_clock;
+  using Task = std::function<void()>;
+
+  ConcurrencyLimiter(const ConcurrencyLimiterConfig& config = ConcurrencyLimiterConfig()) : config_(config) {}
+
+  ConcurrencyLimiter(const ConcurrencyLimiter&) = delete;
+  ConcurrencyLimiter& operator=(const ConcurrencyLimiter&) = delete;
+
+  // Runs `task` once a slot of `model` is free: on the calling thread if one is free now, or else on the thread that
+  // releases a slot. The task must be short and must not block.
+  void acquire(const std::string& model, Task task) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      Endpoint& endpoint = endpointOf(model);
+      if (!endpoint.waiters.empty() || static_cast<double>(endpoint.in_flight) + 1.0 > endpoint.limit) {
+        endpoint.waiters.push_back(std::move(task));
+        return;
+      }
+      ++endpoint.in_flight;
+    }
+    task();
+  }
+
+  // Blocks the calling thread until a slot of `model` is free.
+  void acquire(const std::string& model) {
+    std::promise<void> slot_promise;
+    std::future<void> slot_ftr = slot_promise.get_future();
+    acquire(model, [&slot_promise]() {
+      slot_promise.set_value();
+    });
+    slot_ftr.get();
+  }
+
+  // Frees the slot taken by `acquire()`. `latency_opt` is the duration of the transfer, or std::nullopt if it failed
+  // without a response, and `is_overloaded` tells whether the server refused the request for lack of capacity.
+  void release(const std::string& model, std::optional<Clock::duration> latency_opt, bool is_overloaded) {
+    std::vector<Task> granted_tasks;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      Endpoint& endpoint = endpointOf(model);
+      --endpoint.in_flight;
+      update(endpoint, latency_opt, is_overloaded);
+      while (!endpoint.waiters.empty() && static_cast<double>(endpoint.in_flight) + 1.0 <= endpoint.limit) {
+        ++endpoint.in_flight;
+        granted_tasks.push_back(std::move(endpoint.waiters.front()));
+        endpoint.waiters.pop_front();
+      }
+    }
+    for (Task& task : granted_tasks) {
+      task();
+    }
+  }
+
+  std::map<std::string, ConcurrencyLimiterStats> stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::map<std::string, ConcurrencyLimiterStats> stats;
+    for (const auto& [model, endpoint] : endpoints_) {
+      stats[model] = ConcurrencyLimiterStats{
+          endpoint.limit, endpoint.in_flight, endpoint.waiters.size(),
+          endpoint.min_latency_opt.has_value()
+              ? std::chrono::duration_cast<std::chrono::microseconds>(endpoint.min_latency_opt.value())
+              : std::chrono::microseconds(0),
+      };
+    }
+    return stats;
+  }
+
+ private:
+  struct Endpoint {
+    double limit = 0.0;
+    std::size_t in_flight = 0;
+    std::deque<Task> waiters;
+    std::optional<Clock::duration> min_latency_opt;
+    Clock::time_point min_latency_time;
+  };
+
+  Endpoint& endpointOf(const std::string& model) {
+    auto [it, is_new] = endpoints_.try_emplace(model);
+    if (is_new) {
+      it->second.limit = std::clamp(config_.initial_limit, config_.min_limit, config_.max_limit);
+    }
+    return it->second;
+  }
+
+  void update(Endpoint& endpoint, std::optional<Clock::duration> latency_opt, bool is_overloaded) {
+    if (is_overloaded) {
+      endpoint.limit = std::max(endpoint.limit * config_.backoff_ratio, config_.min_limit);
+      return;
+    }
+    if (!latency_opt.has_value()) {
+      return;
+    }
+
+    const Clock::duration latency = std::max(latency_opt.value(), Clock::duration(1));
+    const Clock::time_point now = Clock::now();
+    if (!endpoint.min_latency_opt.has_value() || latency < endpoint.min_latency_opt.value() ||
+        endpoint.min_latency_time + config_.min_latency_window < now) {
+      endpoint.min_latency_opt = latency;
+      endpoint.min_latency_time = now;
+    }
+
+    // With less than half of the limit in use, the latency tells nothing about a higher limit.
+    if (static_cast<double>(endpoint.in_flight + 1) < endpoint.limit / 2.0) {
+      return;
+    }
+    const double gradient = std::clamp(config_.tolerance * static_cast<double>(endpoint.min_latency_opt->count()) /
+                                           static_cast<double>(latency.count()),
+                                       0.5, 1.0);
+    const double new_limit = endpoint.limit * gradient + std::sqrt(endpoint.limit);
+    endpoint.limit = std::clamp(endpoint.limit * (1.0 - config_.smoothing) + new_limit * config_.smoothing,
+                                config_.min_limit, config_.max_limit);
+  }
+
+  const ConcurrencyLimiterConfig config_;
+
+  mutable std::mutex mutex_;
+  std::unordered_map<std::string, Endpoint> endpoints_;
+};
+
+}  // namespace huggingface_api_cpp::inference
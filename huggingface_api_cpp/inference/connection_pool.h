@@ -0,0 +1,183 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include <curl/curl.h>
+#include <curlpp/cURLpp.hpp>
+#include <curlpp/Easy.hpp>
+
+namespace huggingface_api_cpp::inference {
+
+struct ConnectionPoolStats {
+  std::uint64_t hits = 0;             // Acquisitions served by an idle handle with a warm connection.
+  std::uint64_t new_connections = 0;  // TCP connections opened by libcurl (including TLS handshakes).
+  std::uint64_t evictions = 0;        // Idle handles dropped for exceeding the capacity or the idle time.
+};
+
+// A thread-safe pool of reusable `curlpp::Easy` handles, grouped by host.
+// A released handle keeps its keep-alive connection open, so the next request to the same host skips the TCP
+// and TLS handshakes. All handles also share one DNS cache and one TLS session cache.
+class ConnectionPool {
+ public:
+  // Owns a pooled handle for the duration of one request, and returns it to the pool on destruction.
+  class Handle {
+   public:
+    Handle(ConnectionPool* pool, const std::string* host, std::unique_ptr<curlpp::Easy> easy)
+        : pool_(pool), host_(host), easy_(std::move(easy)) {}
+
+    Handle(Handle&& other) = default;
+    Handle& operator=(Handle&& other) = delete;
+
+    ~Handle() {
+      if (easy_) {
+        pool_->release(*host_, std::move(easy_));
+      }
+    }
+
+    curlpp::Easy& easy() {
+      return *easy_;
+    }
+
+   private:
+    ConnectionPool* pool_;
+    const std::string* host_;  // The key of the host in the pool, which is never erased.
+    std::unique_ptr<curlpp::Easy> easy_;
+  };
+
+  ConnectionPool(std::size_t max_idle_per_host = 16,
+                 std::chrono::seconds max_idle_time = std::chrono::seconds(60))
+      : max_idle_per_host_(max_idle_per_host), max_idle_time_(max_idle_time), share_(curl_share_init()) {
+    curl_share_setopt(share_, CURLSHOPT_LOCKFUNC, &ConnectionPool::LockShare);
+    curl_share_setopt(share_, CURLSHOPT_UNLOCKFUNC, &ConnectionPool::UnlockShare);
+    curl_share_setopt(share_, CURLSHOPT_USERDATA, this);
+    curl_share_setopt(share_, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+    curl_share_setopt(share_, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+  }
+
+  ConnectionPool(const ConnectionPool&) = delete;
+  ConnectionPool& operator=(const ConnectionPool&) = delete;
+
+  ~ConnectionPool() {
+    // The handles must be cleaned up before the share object they refer to.
+    idle_handles_.clear();
+    curl_share_cleanup(share_);
+  }
+
+  // Returns a handle for `url` with all the options reset. The connection cache of the handle is kept.
+  Handle acquire(std::string_view url) {
+    const std::string_view host = HostOf(url);
+    std::unique_ptr<curlpp::Easy> easy;
+    const std::string* pooled_host = nullptr;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      evictExpired(std::chrono::steady_clock::now());
+      auto it = idle_handles_.find(host);
+      if (it == idle_handles_.end()) {
+        it = idle_handles_.emplace(std::string(host), std::deque<IdleHandle>()).first;
+      }
+      pooled_host = &it->first;
+      if (!it->second.empty()) {
+        // LIFO, since the most recently used connection is the least likely to be closed by the server.
+        easy = std::move(it->second.back().easy);
+        it->second.pop_back();
+        ++stats_.hits;
+      }
+    }
+
+    if (easy) {
+      easy->reset();
+    } else {
+      easy = std::make_unique<curlpp::Easy>();
+    }
+
+    CURL* curl_handle = easy->getHandle();
+    curl_easy_setopt(curl_handle, CURLOPT_SHARE, share_);
+    curl_easy_setopt(curl_handle, CURLOPT_TCP_KEEPALIVE, 1L);
+    curl_easy_setopt(curl_handle, CURLOPT_TCP_KEEPIDLE, 30L);
+    curl_easy_setopt(curl_handle, CURLOPT_TCP_KEEPINTVL, 15L);
+
+    return Handle(this, pooled_host, std::move(easy));
+  }
+
+  ConnectionPoolStats stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+  }
+
+  // Returns "scheme://host[:port]" of `url`, which is the granularity libcurl reuses connections at, as a view of it.
+  static std::string_view HostOf(std::string_view url) {
+    const std::size_t scheme_end = url.find("://");
+    const std::size_t host_begin = (scheme_end == std::string_view::npos) ? 0 : scheme_end + 3;
+    const std::size_t host_end = url.find('/', host_begin);
+    return url.substr(0, host_end);
+  }
+
+ private:
+  // Looks the hosts up by `std::string_view`, without copying them out of the URLs.
+  struct HostHash {
+    using is_transparent = void;
+
+    std::size_t operator()(std::string_view host) const {
+      return std::hash<std::string_view>()(host);
+    }
+  };
+
+  struct IdleHandle {
+    std::unique_ptr<curlpp::Easy> easy;
+    std::chrono::steady_clock::time_point released_at;
+  };
+
+  void release(const std::string& host, std::unique_ptr<curlpp::Easy> easy) {
+    curl_off_t num_connects = 0;
+    curl_easy_getinfo(easy->getHandle(), CURLINFO_NUM_CONNECTS, &num_connects);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats_.new_connections += num_connects;
+
+    std::deque<IdleHandle>& idle_handles = idle_handles_.find(host)->second;
+    idle_handles.push_back({std::move(easy), std::chrono::steady_clock::now()});
+    while (max_idle_per_host_ < idle_handles.size()) {
+      idle_handles.pop_front();
+      ++stats_.evictions;
+    }
+  }
+
+  void evictExpired(std::chrono::steady_clock::time_point now) {
+    for (auto& [host, idle_handles] : idle_handles_) {
+      while (!idle_handles.empty() && max_idle_time_ < now - idle_handles.front().released_at) {
+        idle_handles.pop_front();
+        ++stats_.evictions;
+      }
+    }
+  }
+
+  static void LockShare(CURL* handle, curl_lock_data data, curl_lock_access access, void* user_data) {
+    static_cast<ConnectionPool*>(user_data)->share_mutexes_[data].lock();
+  }
+
+  static void UnlockShare(CURL* handle, curl_lock_data data, void* user_data) {
+    static_cast<ConnectionPool*>(user_data)->share_mutexes_[data].unlock();
+  }
+
+  const std::size_t max_idle_per_host_;
+  const std::chrono::seconds max_idle_time_;
+
+  curlpp::Cleanup curlpp_cleanup_;  // Keeps libcurl initialized while any handle is alive.
+  CURLSH* share_;
+  std::mutex share_mutexes_[CURL_LOCK_DATA_LAST];
+
+  mutable std::mutex mutex_;
+  std::unordered_map<std::string, std::deque<IdleHandle>, HostHash, std::equal_to<>> idle_handles_;
+  ConnectionPoolStats stats_;
+};
+
+}  // namespace huggingface_api_cpp::inference
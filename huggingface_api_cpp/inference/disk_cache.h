@@ -0,0 +1,352 @@
+#pragma once
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include "huggingface_api_cpp/inference/cache_key.h"
+
+namespace huggingface_api_cpp::inference {
+
+struct DiskCacheConfig {
+  std::filesystem::path directory_path;
+  std::chrono::seconds max_age = std::chrono::hours(24);
+  bool cache_blobs = true;  // Whether to also store the files written by `textToImage()`.
+};
+
+struct DiskCacheStats {
+  std::uint64_t hits = 0;
+  std::uint64_t misses = 0;
+  std::uint64_t num_entries = 0;
+  std::uint64_t log_bytes = 0;
+};
+
+// A persistent response cache made of three parts in `DiskCacheConfig::directory_path`:
+//   - "responses.log": an append-only log of the records (header + value).
+//   - "index.bin": a memory-mapped open-addressing hash table from `CacheKey` to record offsets in the log.
+//   - "blobs/": blob outputs stored as content-addressed files. Their records hold the content address.
+// The log is the source of truth. Records appended after the last index update (e.g. after a crash) are re-indexed
+// on open. The cache is thread-safe, but must not be shared by several processes.
+class DiskCache {
+ public:
+  DiskCache(const DiskCacheConfig& config) : config_(config) {
+    std::filesystem::create_directories(config_.directory_path / "blobs");
+
+    const std::filesystem::path log_path = config_.directory_path / "responses.log";
+    log_fd_ = ::open(log_path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (log_fd_ < 0) {
+      throw std::system_error(errno, std::generic_category(), "Cannot open " + log_path.string());
+    }
+    struct stat log_stat;
+    ::fstat(log_fd_, &log_stat);
+    log_size_ = log_stat.st_size;
+
+    openIndex();
+    recover();
+  }
+
+  DiskCache(const DiskCache&) = delete;
+  DiskCache& operator=(const DiskCache&) = delete;
+
+  ~DiskCache() {
+    unmapIndex();
+    ::close(index_fd_);
+    ::close(log_fd_);
+  }
+
+  std::optional<std::string> get(const CacheKey& cache_key) {
+    std::optional<std::string> value_opt = read(cache_key, /*blob=*/false);
+    (value_opt.has_value() ? hits_ : misses_).fetch_add(1, std::memory_order_relaxed);
+    return value_opt;
+  }
+
+  void put(const CacheKey& cache_key, const std::string& value) {
+    append(cache_key, value, /*blob=*/false);
+  }
+
+  // Returns the path of the cached blob file for `cache_key`, if any.
+  std::optional<std::filesystem::path> getBlob(const CacheKey& cache_key) {
+    std::optional<std::filesystem::path> blob_path_opt;
+    const std::optional<std::string> content_address_opt = read(cache_key, /*blob=*/true);
+    if (content_address_opt.has_value()) {
+      const std::filesystem::path blob_path = config_.directory_path / "blobs" / content_address_opt.value();
+      if (std::filesystem::exists(blob_path)) {
+        blob_path_opt = blob_path;
+      }
+    }
+    (blob_path_opt.has_value() ? hits_ : misses_).fetch_add(1, std::memory_order_relaxed);
+    return blob_path_opt;
+  }
+
+  // Copies the file at `file_path` into the blob store, unless a blob with the same contents already exists.
+  void putBlob(const CacheKey& cache_key, const std::filesystem::path& file_path) {
+    std::ifstream input_file_stream(file_path, std::ios::in | std::ios::binary);
+    const std::string contents((std::istreambuf_iterator<char>(input_file_stream)), std::istreambuf_iterator<char>());
+    if (!input_file_stream.good() && !input_file_stream.eof()) {
+      return;
+    }
+    putBlobContents(cache_key, contents);
+  }
+
+  // Same as `putBlob()`, but takes the blob contents instead of a file.
+  void putBlobContents(const CacheKey& cache_key, std::string_view contents) {
+    const CacheKey content_key = MakeCacheKey("", contents);
+    char content_address[33];
+    std::snprintf(content_address, sizeof(content_address), "%016llx%016llx",
+                  static_cast<unsigned long long>(content_key.hash), static_cast<unsigned long long>(content_key.check));
+
+    const std::filesystem::path blob_path = config_.directory_path / "blobs" / content_address;
+    if (!std::filesystem::exists(blob_path)) {
+      // Writes to a temporary file first so that a partially written blob is never visible. The name is unique per
+      // thread, since concurrent calls may store the same contents.
+      const std::filesystem::path temporary_path =
+          blob_path.string() + ".tmp" + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id()));
+      {
+        std::ofstream output_file_stream(temporary_path, std::ios::out | std::ios::binary);
+        output_file_stream.write(contents.data(), contents.size());
+      }
+      std::filesystem::rename(temporary_path, blob_path);
+    }
+
+    append(cache_key, content_address, /*blob=*/true);
+  }
+
+  DiskCacheStats stats() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    DiskCacheStats stats;
+    stats.hits = hits_.load(std::memory_order_relaxed);
+    stats.misses = misses_.load(std::memory_order_relaxed);
+    stats.num_entries = index_header_->num_entries;
+    stats.log_bytes = log_size_;
+    return stats;
+  }
+
+ private:
+  static constexpr std::uint32_t kRecordMagic = 0x48464331;  // "HFC1"
+  static constexpr std::uint64_t kIndexMagic = 0x4846494e44455831;  // "HFINDEX1"
+  static constexpr std::uint32_t kBlobFlag = 1;
+  static constexpr std::uint64_t kInitialCapacity = 1024;
+
+  struct RecordHeader {
+    std::uint32_t magic;
+    std::uint32_t flags;
+    std::uint64_t hash;
+    std::uint64_t check;
+    std::int64_t written_at;  // Seconds since the Unix epoch.
+    std::uint64_t value_size;
+  };
+
+  struct IndexHeader {
+    std::uint64_t magic;
+    std::uint64_t capacity;     // Number of slots, a power of two.
+    std::uint64_t num_entries;
+    std::uint64_t log_size;     // Log size covered by the index.
+  };
+
+  struct Slot {
+    std::uint64_t hash;
+    std::uint64_t check;
+    std::uint64_t offset_plus_one;  // 0 for an empty slot.
+  };
+
+  std::optional<std::string> read(const CacheKey& cache_key, bool blob) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    const Slot* slot = findSlot(cache_key);
+    if (slot == nullptr || slot->offset_plus_one == 0) {
+      return std::nullopt;
+    }
+
+    const std::uint64_t offset = slot->offset_plus_one - 1;
+    RecordHeader record_header;
+    if (::pread(log_fd_, &record_header, sizeof(record_header), offset) != sizeof(record_header) ||
+        record_header.magic != kRecordMagic || record_header.hash != cache_key.hash ||
+        record_header.check != cache_key.check || ((record_header.flags & kBlobFlag) != 0) != blob) {
+      return std::nullopt;
+    }
+
+    const std::int64_t age = UnixNow() - record_header.written_at;
+    if (config_.max_age.count() < age) {
+      return std::nullopt;
+    }
+
+    std::string value(record_header.value_size, '\0');
+    const ssize_t read_size = ::pread(log_fd_, value.data(), value.size(), offset + sizeof(record_header));
+    if (read_size < 0 || static_cast<std::size_t>(read_size) != value.size()) {
+      return std::nullopt;
+    }
+    return value;
+  }
+
+  void append(const CacheKey& cache_key, const std::string& value, bool blob) {
+    const RecordHeader record_header{kRecordMagic, blob ? kBlobFlag : 0, cache_key.hash, cache_key.check,
+                                     UnixNow(), value.size()};
+
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    const std::uint64_t offset = log_size_;
+    if (::pwrite(log_fd_, &record_header, sizeof(record_header), offset) != sizeof(record_header) ||
+        ::pwrite(log_fd_, value.data(), value.size(), offset + sizeof(record_header)) !=
+            static_cast<ssize_t>(value.size())) {
+      return;  // E.g. the disk is full. The record is not indexed, so it will be overwritten by the next append.
+    }
+    log_size_ = offset + sizeof(record_header) + value.size();
+
+    insert(cache_key, offset);
+    index_header_->log_size = log_size_;
+  }
+
+  // Returns the slot of `cache_key`, or the empty slot where it would be inserted.
+  Slot* findSlot(const CacheKey& cache_key) const {
+    const std::uint64_t mask = index_header_->capacity - 1;
+    for (std::uint64_t i = cache_key.hash & mask;; i = (i + 1) & mask) {
+      Slot& slot = slots_[i];
+      if (slot.offset_plus_one == 0 || (slot.hash == cache_key.hash && slot.check == cache_key.check)) {
+        return &slot;
+      }
+    }
+  }
+
+  void insert(const CacheKey& cache_key, std::uint64_t offset) {
+    // Keeps the load factor at most 1/2 so that probe sequences stay short.
+    if (index_header_->capacity < 2 * (index_header_->num_entries + 1)) {
+      resizeIndex(2 * index_header_->capacity);
+    }
+
+    Slot* slot = findSlot(cache_key);
+    if (slot->offset_plus_one == 0) {
+      ++index_header_->num_entries;
+    }
+    *slot = {cache_key.hash, cache_key.check, offset + 1};
+  }
+
+  void openIndex() {
+    const std::filesystem::path index_path = config_.directory_path / "index.bin";
+    index_fd_ = ::open(index_path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (index_fd_ < 0) {
+      throw std::system_error(errno, std::generic_category(), "Cannot open " + index_path.string());
+    }
+
+    struct stat index_stat;
+    ::fstat(index_fd_, &index_stat);
+    if (static_cast<std::size_t>(index_stat.st_size) < sizeof(IndexHeader)) {
+      resetIndex(kInitialCapacity);
+      return;
+    }
+
+    IndexHeader index_header;
+    ::pread(index_fd_, &index_header, sizeof(index_header), 0);
+    const bool is_valid = index_header.magic == kIndexMagic && index_header.capacity != 0 &&
+                          (index_header.capacity & (index_header.capacity - 1)) == 0 &&
+                          static_cast<std::size_t>(index_stat.st_size) == IndexFileSize(index_header.capacity) &&
+                          index_header.log_size <= log_size_;
+    if (!is_valid) {
+      resetIndex(kInitialCapacity);
+      return;
+    }
+    mapIndex(index_header.capacity);
+  }
+
+  // Indexes the records appended after the index was last updated.
+  void recover() {
+    std::uint64_t offset = index_header_->log_size;
+    RecordHeader record_header;
+    while (::pread(log_fd_, &record_header, sizeof(record_header), offset) == sizeof(record_header) &&
+           record_header.magic == kRecordMagic &&
+           offset + sizeof(record_header) + record_header.value_size <= log_size_) {
+      insert({record_header.hash, record_header.check}, offset);
+      offset += sizeof(record_header) + record_header.value_size;
+    }
+
+    // Drops a torn record at the tail, if any.
+    log_size_ = offset;
+    ::ftruncate(log_fd_, log_size_);
+    index_header_->log_size = log_size_;
+  }
+
+  void resetIndex(std::uint64_t capacity) {
+    unmapIndex();
+    ::ftruncate(index_fd_, 0);
+    ::ftruncate(index_fd_, IndexFileSize(capacity));
+    mapIndex(capacity);
+    *index_header_ = {kIndexMagic, capacity, 0, 0};
+  }
+
+  void resizeIndex(std::uint64_t capacity) {
+    const std::uint64_t old_capacity = index_header_->capacity;
+    const std::uint64_t log_size = index_header_->log_size;
+    std::vector<Slot> old_slots(slots_, slots_ + old_capacity);
+
+    resetIndex(capacity);
+    index_header_->log_size = log_size;
+    for (const Slot& old_slot : old_slots) {
+      if (old_slot.offset_plus_one != 0) {
+        Slot* slot = findSlot({old_slot.hash, old_slot.check});
+        *slot = old_slot;
+        ++index_header_->num_entries;
+      }
+    }
+  }
+
+  void mapIndex(std::uint64_t capacity) {
+    mapped_size_ = IndexFileSize(capacity);
+    void* mapped = ::mmap(nullptr, mapped_size_, PROT_READ | PROT_WRITE, MAP_SHARED, index_fd_, 0);
+    if (mapped == MAP_FAILED) {
+      throw std::system_error(errno, std::generic_category(), "Cannot map the disk cache index");
+    }
+    index_header_ = static_cast<IndexHeader*>(mapped);
+    slots_ = reinterpret_cast<Slot*>(static_cast<char*>(mapped) + sizeof(IndexHeader));
+  }
+
+  void unmapIndex() {
+    if (index_header_ != nullptr) {
+      ::munmap(index_header_, mapped_size_);
+      index_header_ = nullptr;
+      slots_ = nullptr;
+    }
+  }
+
+  static std::size_t IndexFileSize(std::uint64_t capacity) {
+    return sizeof(IndexHeader) + capacity * sizeof(Slot);
+  }
+
+  static std::int64_t UnixNow() {
+    return std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+  }
+
+  const DiskCacheConfig config_;
+
+  mutable std::shared_mutex mutex_;
+  int log_fd_ = -1;
+  std::uint64_t log_size_ = 0;
+  int index_fd_ = -1;
+  std::size_t mapped_size_ = 0;
+  IndexHeader* index_header_ = nullptr;
+  Slot* slots_ = nullptr;
+
+  std::atomic<std::uint64_t> hits_ = 0;
+  std::atomic<std::uint64_t> misses_ = 0;
+};
+
+}  // namespace huggingface_api_cpp::inference
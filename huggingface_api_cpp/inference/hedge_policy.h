@@ -0,0 +1,123 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "huggingface_api_cpp/inference/retry_policy.h"
+
+namespace huggingface_api_cpp::inference {
+
+// Hedges are extra requests like retries, so they are limited by the same kind of budget. This one allows about one
+// hedge per twenty calls, and is shared by all the calls of the process unless their `HedgePolicy` has its own.
+inline const std::shared_ptr<RetryBudget>& GlobalHedgeBudget() {
+  static const std::shared_ptr<RetryBudget> kGlobal = std::make_shared<RetryBudget>(0.05, 1.0, 10.0);
+  return kGlobal;
+}
+
+// If `enabled`, a duplicate of a request that has not completed after a delay is sent, and whichever response comes
+// first is used: the other transfer is cancelled. A failed response only wins once no other transfer is in flight.
+// Only applies to the calls performed by a non-blocking transport such as `MultiTransport`, whose response is not
+// streamed to a file or a sink.
+struct HedgePolicy {
+  bool enabled = false;
+
+  // The delay is the `delay_percentile` of the recent latencies of the model, or `initial_delay` until `min_samples`
+  // of them have been measured. A zero percentile means always `initial_delay`.
+  double delay_percentile = 0.95;
+  std::chrono::milliseconds initial_delay = std::chrono::milliseconds(500);
+  std::chrono::milliseconds min_delay = std::chrono::milliseconds(10);
+  std::size_t min_samples = 20;
+
+  // nullptr means unlimited.
+  std::shared_ptr<RetryBudget> budget = GlobalHedgeBudget();
+};
+
+struct HedgeStats {
+  std::uint64_t hedges = 0;           // Duplicate requests sent.
+  std::uint64_t won_hedges = 0;       // Hedges whose response was used, i.e. which beat the original request.
+  std::uint64_t rejected_hedges = 0;  // Hedges not sent because the budget was exhausted.
+};
+
+// Keeps the latest latencies of each model, from which the delays of the hedges are taken, and counts the hedges.
+class HedgeTracker {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  static constexpr std::size_t kWindowSize = 256;
+
+  HedgeTracker() = default;
+
+  HedgeTracker(const HedgeTracker&) = delete;
+  HedgeTracker& operator=(const HedgeTracker&) = delete;
+
+  void recordLatency(const std::string& model, Clock::duration latency) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Window& window = windows_[model];
+    if (window.latencies.size() < kWindowSize) {
+      window.latencies.push_back(latency);
+    } else {
+      window.latencies[window.next] = latency;
+    }
+    window.next = (window.next + 1) % kWindowSize;
+  }
+
+  std::chrono::milliseconds delay(const std::string& model, const HedgePolicy& hedge_policy) const {
+    std::vector<Clock::duration> latencies;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      auto it = windows_.find(model);
+      if (it != windows_.end()) {
+        latencies = it->second.latencies;
+      }
+    }
+    if (hedge_policy.delay_percentile <= 0.0 || latencies.empty() || latencies.size() < hedge_policy.min_samples) {
+      return std::max(hedge_policy.initial_delay, hedge_policy.min_delay);
+    }
+
+    const double rank = std::ceil(std::min(hedge_policy.delay_percentile, 1.0) * static_cast<double>(latencies.size()));
+    const auto nth = latencies.begin() + (std::max(static_cast<std::size_t>(rank), std::size_t(1)) - 1);
+    std::nth_element(latencies.begin(), nth, latencies.end());
+    return std::max(std::chrono::ceil<std::chrono::milliseconds>(*nth), hedge_policy.min_delay);
+  }
+
+  void recordHedge() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++stats_.hedges;
+  }
+
+  void recordWonHedge() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++stats_.won_hedges;
+  }
+
+  void recordRejectedHedge() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++stats_.rejected_hedges;
+  }
+
+  HedgeStats stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+  }
+
+ private:
+  // A ring buffer of the latest `kWindowSize` latencies.
+  struct Window {
+    std::vector<Clock::duration> latencies;
+    std::size_t next = 0;
+  };
+
+  mutable std::mutex mutex_;
+  std::unordered_map<std::string, Window> windows_;
+  HedgeStats stats_;
+};
+
+}  // namespace huggingface_api_cpp::inference
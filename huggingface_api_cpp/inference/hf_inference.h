@@ -1,11 +1,25 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
 #include <filesystem>
 #include <fstream>
+#include <functional>
 #include <future>
 #include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
 #include <sstream>
 #include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
 #include <vector>
 
 #include <curlpp/cURLpp.hpp>
@@ -16,22 +30,235 @@
 #include <nlohmann/json.hpp>
 
 #include "huggingface_api_cpp/inference/args.h"
+#include "huggingface_api_cpp/inference/blob_output.h"
+#include "huggingface_api_cpp/inference/buffer_pool.h"
+#include "huggingface_api_cpp/inference/cache_key.h"
+#include "huggingface_api_cpp/inference/compression.h"
+#include "huggingface_api_cpp/inference/concurrency_limiter.h"
+#include "huggingface_api_cpp/inference/connection_pool.h"
+#include "huggingface_api_cpp/inference/disk_cache.h"
+#include "huggingface_api_cpp/inference/hedge_policy.h"
+#include "huggingface_api_cpp/inference/metrics.h"
+#include "huggingface_api_cpp/inference/multi_transport.h"
 #include "huggingface_api_cpp/inference/options.h"
+#include "huggingface_api_cpp/inference/rate_limiter.h"
+#include "huggingface_api_cpp/inference/request_body.h"
+#include "huggingface_api_cpp/inference/request_json.h"
+#include "huggingface_api_cpp/inference/response_cache.h"
+#include "huggingface_api_cpp/inference/result_stream.h"
+#include "huggingface_api_cpp/inference/results.h"
+#include "huggingface_api_cpp/inference/retry_policy.h"
+#include "huggingface_api_cpp/inference/retry_timer.h"
+#include "huggingface_api_cpp/inference/scheduler.h"
+#include "huggingface_api_cpp/inference/single_flight.h"
+#include "huggingface_api_cpp/inference/thread_pool.h"
+#include "huggingface_api_cpp/inference/tracing.h"
+#include "huggingface_api_cpp/inference/transport.h"
 
 namespace huggingface_api_cpp::inference {
 
 class HfInference {
  public:
-  HfInference(const std::string& api_key = "") : api_key_(api_key)  {}
+  // Receives the output string of an asynchronous call. Invoked on a worker thread of the thread pool, or on an I/O
+  // thread of a non-blocking transport such as `MultiTransport`.
+  using OutputCallback = std::function<void(std::string output_string)>;
+
+  static constexpr const char* kDefaultEndpoint = "https://api-inference.huggingface.co/models/";
+
+  HfInference(const std::string& api_key = "")
+      : api_key_(api_key),
+        connection_pool_(std::make_shared<ConnectionPool>()),
+        transport_(std::make_shared<EasyTransport>(connection_pool_)),
+        body_buffer_pool_(std::make_shared<BufferPool>()),
+        hedge_tracker_(std::make_shared<HedgeTracker>()),
+        retry_timer_(std::make_shared<RetryTimer>()),
+        thread_pool_(std::make_shared<ThreadPool>()) {
+    makeHeaderLists();
+  }
 
   void setApiKey(const std::string& api_key) {
     api_key_ = api_key;
+    makeHeaderLists();
   }
 
   void setOutputFilePath(const std::filesystem::path& output_directory_path) {
     output_file_path_ = output_directory_path;
   }
 
+  // Sends the requests to `endpoint` followed by the model id instead of the hosted Inference API, e.g. to a local
+  // server such as "http://localhost:8080/models/".
+  void setEndpoint(const std::string& endpoint) {
+    endpoint_ = (endpoint.empty() || endpoint.back() == '/') ? endpoint : endpoint + '/';
+  }
+
+  const std::string& endpoint() const {
+    return endpoint_;
+  }
+
+  // Replaces the executor that runs the `*Async()` methods, e.g. to share one pool between several instances.
+  // The instance must outlive all of its pending asynchronous calls.
+  void setThreadPool(const std::shared_ptr<ThreadPool>& thread_pool) {
+    thread_pool_ = thread_pool;
+  }
+
+  // Replaces the pool of keep-alive connections, e.g. to share warm connections between several instances.
+  // Switches back to an `EasyTransport` using that pool.
+  void setConnectionPool(const std::shared_ptr<ConnectionPool>& connection_pool) {
+    connection_pool_ = connection_pool;
+    transport_ = std::make_shared<EasyTransport>(connection_pool_);
+  }
+
+  // Enables an in-process cache of the responses, keyed on the URL of the model and the request body. Requests with
+  // `Options::use_cache == false`, file outputs, and sampling (non-deterministic) parameters bypass it.
+  void enableResponseCache(const ResponseCacheConfig& response_cache_config = ResponseCacheConfig()) {
+    response_cache_ = std::make_shared<ResponseCache>(response_cache_config);
+  }
+
+  void disableResponseCache() {
+    response_cache_.reset();
+  }
+
+  ResponseCacheStats responseCacheStats() const {
+    return response_cache_ ? response_cache_->stats() : ResponseCacheStats();
+  }
+
+  // Enables a persistent cache tier behind the in-memory one, which survives restarts. Follows the same bypass rules,
+  // except that the files written by `textToImage()` are stored too (see `DiskCacheConfig::cache_blobs`).
+  void enableDiskCache(const DiskCacheConfig& disk_cache_config) {
+    disk_cache_config_ = disk_cache_config;
+    disk_cache_ = std::make_shared<DiskCache>(disk_cache_config);
+  }
+
+  void disableDiskCache() {
+    disk_cache_.reset();
+  }
+
+  DiskCacheStats diskCacheStats() const {
+    return disk_cache_ ? disk_cache_->stats() : DiskCacheStats();
+  }
+
+  // Makes concurrent calls with identical model, options and inputs share one in-flight transfer. File and
+  // streamed outputs are never coalesced.
+  void enableRequestCoalescing() {
+    single_flight_ = std::make_shared<SingleFlight>();
+  }
+
+  void disableRequestCoalescing() {
+    single_flight_.reset();
+  }
+
+  std::uint64_t numCoalescedCalls() const {
+    return single_flight_ ? single_flight_->numCoalesced() : 0;
+  }
+
+  // Limits the rate of the requests per model and in total. The calls wait for their turn before being sent, and the
+  // rate of a model is lowered when the server throttles it (429, Retry-After).
+  void enableRateLimiter(const RateLimiterConfig& rate_limiter_config = RateLimiterConfig()) {
+    rate_limiter_ = std::make_shared<RateLimiter>(rate_limiter_config);
+  }
+
+  void disableRateLimiter() {
+    rate_limiter_.reset();
+  }
+
+  RateLimiterStats rateLimiterStats() const {
+    return rate_limiter_ ? rate_limiter_->stats() : RateLimiterStats();
+  }
+
+  // Limits the requests in flight per model, with a limit that adapts to the latencies of the transfers: it grows
+  // while they stay close to their minimum, and shrinks when they rise, i.e. when the server starts queueing, or when
+  // it answers 429, 503 or 504. The calls beyond the limit wait for a slot, in order.
+  void enableConcurrencyLimiter(
+      const ConcurrencyLimiterConfig& concurrency_limiter_config = ConcurrencyLimiterConfig()) {
+    concurrency_limiter_ = std::make_shared<ConcurrencyLimiter>(concurrency_limiter_config);
+  }
+
+  void disableConcurrencyLimiter() {
+    concurrency_limiter_.reset();
+  }
+
+  // The current limit, the requests in flight and the queue depth of each model called since enabled.
+  std::map<std::string, ConcurrencyLimiterStats> concurrencyLimiterStats() const {
+    return concurrency_limiter_ ? concurrency_limiter_->stats() : std::map<std::string, ConcurrencyLimiterStats>();
+  }
+
+  // Limits the requests in flight over all the models, and grants the slots by the priority class of the calls, then
+  // fairly among the tenants of a class, as set by `Options::scheduling_policy`. The calls whose deadline passes while
+  // they wait are dropped before being sent.
+  void enableScheduler(const SchedulerConfig& scheduler_config = SchedulerConfig()) {
+    scheduler_ = std::make_shared<Scheduler>(scheduler_config);
+  }
+
+  void disableScheduler() {
+    scheduler_.reset();
+  }
+
+  // The calls in flight and waiting, and the time they waited for a slot, of each priority class since enabled.
+  std::map<Priority, SchedulerStats> schedulerStats() const {
+    return scheduler_ ? scheduler_->stats() : std::map<Priority, SchedulerStats>();
+  }
+
+  // Records the phase timings, sizes, retries and response codes of the calls into histograms and counters per model
+  // and task. Only the calls that are sent are recorded, not those served by a cache or a coalesced flight.
+  void enableRequestMetrics() {
+    request_metrics_ = std::make_shared<RequestMetrics>();
+  }
+
+  void disableRequestMetrics() {
+    request_metrics_.reset();
+  }
+
+  // Sorted by model, then by task.
+  std::vector<RequestMetricsSnapshot> requestMetrics() const {
+    return request_metrics_ ? request_metrics_->snapshot() : std::vector<RequestMetricsSnapshot>();
+  }
+
+  // The request metrics in the Prometheus text exposition format, e.g. to serve on a /metrics endpoint.
+  std::string prometheusMetrics() const {
+    return FormatPrometheusMetrics(requestMetrics());
+  }
+
+  // Records the stages of the calls into a ring buffer per thread: the serialization of the body or the reading of the
+  // input, the cache lookup, the wait for the limiters, the transfer, the processing of the response, and the parsing
+  // of the typed results. Cheap enough to leave enabled, since recording an event takes no lock.
+  void enableTracing(const TracerConfig& tracer_config = TracerConfig()) {
+    tracer_ = std::make_shared<Tracer>(tracer_config);
+  }
+
+  void disableTracing() {
+    tracer_.reset();
+  }
+
+  TracerStats tracerStats() const {
+    return tracer_ ? tracer_->stats() : TracerStats();
+  }
+
+  // The events that ended within the last `window`, or all those still buffered if zero, in the Chrome trace format.
+  // Saved to a .json file, it opens in https://ui.perfetto.dev or chrome://tracing.
+  std::string chromeTraceJson(std::chrono::milliseconds window = std::chrono::milliseconds(0)) const {
+    return tracer_ ? tracer_->chromeTraceJson(window) : "{\"traceEvents\":[]}";
+  }
+
+  // Of the calls made with `Options::hedge_policy` enabled.
+  HedgeStats hedgeStats() const {
+    return hedge_tracker_->stats();
+  }
+
+  // Replaces the transport used by all the task methods, e.g. with a `MultiTransport` to keep thousands of
+  // asynchronous calls in flight from a few I/O threads.
+  void setTransport(const std::shared_ptr<Transport>& transport) {
+    transport_ = transport;
+  }
+
+  ConnectionPoolStats connectionPoolStats() const {
+    return connection_pool_->stats();
+  }
+
+  // Of the buffers that the JSON request bodies are written into.
+  BufferPoolStats bodyBufferPoolStats() const {
+    return body_buffer_pool_->stats();
+  }
+
   /////////////////////////////////
   // Natural Language Processing //
   /////////////////////////////////
@@ -42,60 +269,252 @@ class HfInference {
     return request(args, other_args, extended_options);
   };
 
+  std::future<std::string> fillMaskAsync(const Args& args, const FillMaskArgs& other_args,
+                                         const Options& options = Options()) const {
+    const ExtendedOptions extended_options(options);
+    return requestAsync(args, other_args, extended_options);
+  }
+
+  void fillMaskAsync(const Args& args, const FillMaskArgs& other_args,
+                     OutputCallback callback, const Options& options = Options()) const {
+    const ExtendedOptions extended_options(options);
+    requestAsync(args, other_args, extended_options, std::move(callback));
+  }
+
+  std::vector<std::string> fillMaskBatch(const Args& args, const FillMaskArgs& other_args,
+                                         const std::vector<std::string>& inputs, const Options& options = Options(),
+                                         const BatchOptions& batch_options = BatchOptions()) const {
+    const ExtendedOptions extended_options(options);
+    return requestBatch(args, other_args, inputs, extended_options, batch_options);
+  }
+
   std::string summarization(const Args& args, const SummarizationArgs& other_args,
                             const Options& options = Options()) const {
     const ExtendedOptions extended_options(options);
     return request(args, other_args, extended_options);
   };
 
+  std::future<std::string> summarizationAsync(const Args& args, const SummarizationArgs& other_args,
+                                              const Options& options = Options()) const {
+    const ExtendedOptions extended_options(options);
+    return requestAsync(args, other_args, extended_options);
+  }
+
+  void summarizationAsync(const Args& args, const SummarizationArgs& other_args,
+                          OutputCallback callback, const Options& options = Options()) const {
+    const ExtendedOptions extended_options(options);
+    requestAsync(args, other_args, extended_options, std::move(callback));
+  }
+
+  std::vector<std::string> summarizationBatch(const Args& args, const SummarizationArgs& other_args,
+                                              const std::vector<std::string>& inputs, const Options& options = Options(),
+                                              const BatchOptions& batch_options = BatchOptions()) const {
+    const ExtendedOptions extended_options(options);
+    return requestBatch(args, other_args, inputs, extended_options, batch_options);
+  }
+
   std::string questionAnswer(const Args& args, const QuestionAnswerArgs& other_args,
                              const Options& options = Options()) const {
     const ExtendedOptions extended_options(options);
     return request(args, other_args, extended_options);
   };
 
+  std::future<std::string> questionAnswerAsync(const Args& args, const QuestionAnswerArgs& other_args,
+                                               const Options& options = Options()) const {
+    const ExtendedOptions extended_options(options);
+    return requestAsync(args, other_args, extended_options);
+  }
+
+  void questionAnswerAsync(const Args& args, const QuestionAnswerArgs& other_args,
+                           OutputCallback callback, const Options& options = Options()) const {
+    const ExtendedOptions extended_options(options);
+    requestAsync(args, other_args, extended_options, std::move(callback));
+  }
+
   std::string tableQuestionAnswer(const Args& args, const TableQuestionAnswerArgs& other_args,
                                   const Options& options = Options()) const {
     const ExtendedOptions extended_options(options);
     return request(args, other_args, extended_options);
   };
 
+  std::future<std::string> tableQuestionAnswerAsync(const Args& args, const TableQuestionAnswerArgs& other_args,
+                                                    const Options& options = Options()) const {
+    const ExtendedOptions extended_options(options);
+    return requestAsync(args, other_args, extended_options);
+  }
+
+  void tableQuestionAnswerAsync(const Args& args, const TableQuestionAnswerArgs& other_args,
+                                OutputCallback callback, const Options& options = Options()) const {
+    const ExtendedOptions extended_options(options);
+    requestAsync(args, other_args, extended_options, std::move(callback));
+  }
+
   std::string textClassification(const Args& args, const TextClassificationArgs& other_args,
                                  const Options& options = Options()) const {
     const ExtendedOptions extended_options(options);
     return request(args, other_args, extended_options);
   };
 
+  std::future<std::string> textClassificationAsync(const Args& args, const TextClassificationArgs& other_args,
+                                                   const Options& options = Options()) const {
+    const ExtendedOptions extended_options(options);
+    return requestAsync(args, other_args, extended_options);
+  }
+
+  void textClassificationAsync(const Args& args, const TextClassificationArgs& other_args,
+                               OutputCallback callback, const Options& options = Options()) const {
+    const ExtendedOptions extended_options(options);
+    requestAsync(args, other_args, extended_options, std::move(callback));
+  }
+
+  std::vector<std::string> textClassificationBatch(const Args& args, const TextClassificationArgs& other_args,
+                                                   const std::vector<std::string>& inputs, const Options& options = Options(),
+                                                   const BatchOptions& batch_options = BatchOptions()) const {
+    const ExtendedOptions extended_options(options);
+    return requestBatch(args, other_args, inputs, extended_options, batch_options);
+  }
+
   std::string textGeneration(const Args& args, const TextGenerationArgs& other_args,
                              const Options& options = Options()) const {
     const ExtendedOptions extended_options(options);
     return request(args, other_args, extended_options);
   }
 
+  std::future<std::string> textGenerationAsync(const Args& args, const TextGenerationArgs& other_args,
+                                               const Options& options = Options()) const {
+    const ExtendedOptions extended_options(options);
+    return requestAsync(args, other_args, extended_options);
+  }
+
+  void textGenerationAsync(const Args& args, const TextGenerationArgs& other_args,
+                           OutputCallback callback, const Options& options = Options()) const {
+    const ExtendedOptions extended_options(options);
+    requestAsync(args, other_args, extended_options, std::move(callback));
+  }
+
+  // Streams the generated tokens as server-sent events, and passes each of them to `token_sink` as soon as it has been
+  // received, on the calling thread or on an I/O thread of a non-blocking transport. The transfer proceeds no faster
+  // than `token_sink` returns.
+  StreamOutput textGeneration(const Args& args, const TextGenerationArgs& other_args,
+                              ResultSink<TokenStreamResult> token_sink, const Options& options = Options()) const {
+    ExtendedOptions extended_options(options);
+    extended_options.stream = true;
+    return requestStream(makeCall(args, other_args, extended_options),
+                         std::make_shared<EventStreamDecoder<TokenStreamResult>>(std::move(token_sink)));
+  }
+
+  // Same as above, but returns immediately. The tokens are consumed from the returned stream.
+  ResultStream<TokenStreamResult> textGenerationStream(const Args& args, const TextGenerationArgs& other_args,
+                                                       const Options& options = Options(),
+                                                       const StreamOptions& stream_options = StreamOptions()) const {
+    ExtendedOptions extended_options(options);
+    extended_options.stream = true;
+    return requestStreamAsync<TokenStreamResult>(args, other_args, extended_options, stream_options);
+  }
+
   std::string tokenClassification(const Args& args, const TokenClassificationArgs& other_args,
                                   const Options& options = Options()) const {
     const ExtendedOptions extended_options(options);
     return request(args, other_args, extended_options);
   }
 
+  std::future<std::string> tokenClassificationAsync(const Args& args, const TokenClassificationArgs& other_args,
+                                                    const Options& options = Options()) const {
+    const ExtendedOptions extended_options(options);
+    return requestAsync(args, other_args, extended_options);
+  }
+
+  void tokenClassificationAsync(const Args& args, const TokenClassificationArgs& other_args,
+                                OutputCallback callback, const Options& options = Options()) const {
+    const ExtendedOptions extended_options(options);
+    requestAsync(args, other_args, extended_options, std::move(callback));
+  }
+
+  std::vector<std::string> tokenClassificationBatch(const Args& args, const TokenClassificationArgs& other_args,
+                                                    const std::vector<std::string>& inputs, const Options& options = Options(),
+                                                    const BatchOptions& batch_options = BatchOptions()) const {
+    const ExtendedOptions extended_options(options);
+    return requestBatch(args, other_args, inputs, extended_options, batch_options);
+  }
+
   std::string translation(const Args& args, const TranslationArgs& other_args,
                           const Options& options = Options()) const {
     const ExtendedOptions extended_options(options);
     return request(args, other_args, extended_options);
   }
 
+  std::future<std::string> translationAsync(const Args& args, const TranslationArgs& other_args,
+                                            const Options& options = Options()) const {
+    const ExtendedOptions extended_options(options);
+    return requestAsync(args, other_args, extended_options);
+  }
+
+  void translationAsync(const Args& args, const TranslationArgs& other_args,
+                        OutputCallback callback, const Options& options = Options()) const {
+    const ExtendedOptions extended_options(options);
+    requestAsync(args, other_args, extended_options, std::move(callback));
+  }
+
+  std::vector<std::string> translationBatch(const Args& args, const TranslationArgs& other_args,
+                                            const std::vector<std::string>& inputs, const Options& options = Options(),
+                                            const BatchOptions& batch_options = BatchOptions()) const {
+    const ExtendedOptions extended_options(options);
+    return requestBatch(args, other_args, inputs, extended_options, batch_options);
+  }
+
   std::string zeroShotClassification(const Args& args, const ZeroShotClassificationArgs& other_args,
                                      const Options& options = Options()) const {
     const ExtendedOptions extended_options(options);
     return request(args, other_args, extended_options);
   }
 
+  std::future<std::string> zeroShotClassificationAsync(const Args& args, const ZeroShotClassificationArgs& other_args,
+                                                       const Options& options = Options()) const {
+    const ExtendedOptions extended_options(options);
+    return requestAsync(args, other_args, extended_options);
+  }
+
+  void zeroShotClassificationAsync(const Args& args, const ZeroShotClassificationArgs& other_args,
+                                   OutputCallback callback, const Options& options = Options()) const {
+    const ExtendedOptions extended_options(options);
+    requestAsync(args, other_args, extended_options, std::move(callback));
+  }
+
   std::string conversational(const Args& args, const ConversationalArgs& other_args,
                              const Options& options = Options()) const {
     const ExtendedOptions extended_options(options);
     return request(args, other_args, extended_options);
   }
 
+  std::future<std::string> conversationalAsync(const Args& args, const ConversationalArgs& other_args,
+                                               const Options& options = Options()) const {
+    const ExtendedOptions extended_options(options);
+    return requestAsync(args, other_args, extended_options);
+  }
+
+  void conversationalAsync(const Args& args, const ConversationalArgs& other_args,
+                           OutputCallback callback, const Options& options = Options()) const {
+    const ExtendedOptions extended_options(options);
+    requestAsync(args, other_args, extended_options, std::move(callback));
+  }
+
+  // Streams the tokens of the response, as `textGeneration()` does.
+  StreamOutput conversational(const Args& args, const ConversationalArgs& other_args,
+                              ResultSink<TokenStreamResult> token_sink, const Options& options = Options()) const {
+    ExtendedOptions extended_options(options);
+    extended_options.stream = true;
+    return requestStream(makeCall(args, other_args, extended_options),
+                         std::make_shared<EventStreamDecoder<TokenStreamResult>>(std::move(token_sink)));
+  }
+
+  ResultStream<TokenStreamResult> conversationalStream(const Args& args, const ConversationalArgs& other_args,
+                                                       const Options& options = Options(),
+                                                       const StreamOptions& stream_options = StreamOptions()) const {
+    ExtendedOptions extended_options(options);
+    extended_options.stream = true;
+    return requestStreamAsync<TokenStreamResult>(args, other_args, extended_options, stream_options);
+  }
+
   //////////////////////
   // Audio Processing //
   //////////////////////
@@ -107,6 +526,20 @@ class HfInference {
     return request(args, other_args, extended_options, other_args.data);
   }
 
+  std::future<std::string> automaticSpeechRecognitionAsync(const Args& args, const AutomaticSpeechRecognitionArgs& other_args,
+                                                           const Options& options = Options()) const {
+    ExtendedOptions extended_options(options);
+    extended_options.binary = true;
+    return requestAsync(args, other_args, extended_options, other_args.data);
+  }
+
+  void automaticSpeechRecognitionAsync(const Args& args, const AutomaticSpeechRecognitionArgs& other_args,
+                                       OutputCallback callback, const Options& options = Options()) const {
+    ExtendedOptions extended_options(options);
+    extended_options.binary = true;
+    requestAsync(args, other_args, extended_options, std::move(callback), other_args.data);
+  }
+
   std::string audioClassification(const Args& args, const AudioClassificationArgs& other_args,
                                   const Options& options = Options()) const {
     ExtendedOptions extended_options(options);
@@ -114,6 +547,20 @@ class HfInference {
     return request(args, other_args, extended_options, other_args.data);
   }
 
+  std::future<std::string> audioClassificationAsync(const Args& args, const AudioClassificationArgs& other_args,
+                                                    const Options& options = Options()) const {
+    ExtendedOptions extended_options(options);
+    extended_options.binary = true;
+    return requestAsync(args, other_args, extended_options, other_args.data);
+  }
+
+  void audioClassificationAsync(const Args& args, const AudioClassificationArgs& other_args,
+                                OutputCallback callback, const Options& options = Options()) const {
+    ExtendedOptions extended_options(options);
+    extended_options.binary = true;
+    requestAsync(args, other_args, extended_options, std::move(callback), other_args.data);
+  }
+
   /////////////////////
   // Computer Vision //
   /////////////////////
@@ -125,6 +572,20 @@ class HfInference {
     return request(args, other_args, extended_options, other_args.data);
   }
 
+  std::future<std::string> imageClassificationAsync(const Args& args, const ImageClassificationArgs& other_args,
+                                                    const Options& options = Options()) const {
+    ExtendedOptions extended_options(options);
+    extended_options.binary = true;
+    return requestAsync(args, other_args, extended_options, other_args.data);
+  }
+
+  void imageClassificationAsync(const Args& args, const ImageClassificationArgs& other_args,
+                                OutputCallback callback, const Options& options = Options()) const {
+    ExtendedOptions extended_options(options);
+    extended_options.binary = true;
+    requestAsync(args, other_args, extended_options, std::move(callback), other_args.data);
+  }
+
   std::string objectDetection(const Args& args, const ObjectDetectionArgs& other_args,
                               const Options& options = Options()) const {
     ExtendedOptions extended_options(options);
@@ -132,6 +593,20 @@ class HfInference {
     return request(args, other_args, extended_options, other_args.data);
   }
 
+  std::future<std::string> objectDetectionAsync(const Args& args, const ObjectDetectionArgs& other_args,
+                                                const Options& options = Options()) const {
+    ExtendedOptions extended_options(options);
+    extended_options.binary = true;
+    return requestAsync(args, other_args, extended_options, other_args.data);
+  }
+
+  void objectDetectionAsync(const Args& args, const ObjectDetectionArgs& other_args,
+                            OutputCallback callback, const Options& options = Options()) const {
+    ExtendedOptions extended_options(options);
+    extended_options.binary = true;
+    requestAsync(args, other_args, extended_options, std::move(callback), other_args.data);
+  }
+
   std::string imageSegmentation(const Args& args, const ImageSegmentationArgs& other_args,
                                 const Options& options = Options()) const {
     ExtendedOptions extended_options(options);
@@ -139,6 +614,32 @@ class HfInference {
     return request(args, other_args, extended_options, other_args.data);
   }
 
+  std::future<std::string> imageSegmentationAsync(const Args& args, const ImageSegmentationArgs& other_args,
+                                                  const Options& options = Options()) const {
+    ExtendedOptions extended_options(options);
+    extended_options.binary = true;
+    return requestAsync(args, other_args, extended_options, other_args.data);
+  }
+
+  void imageSegmentationAsync(const Args& args, const ImageSegmentationArgs& other_args,
+                              OutputCallback callback, const Options& options = Options()) const {
+    ExtendedOptions extended_options(options);
+    extended_options.binary = true;
+    requestAsync(args, other_args, extended_options, std::move(callback), other_args.data);
+  }
+
+  // Decodes the segments while the response arrives, and passes each of them to `result_sink` as soon as its mask has
+  // been received, on the calling thread or on an I/O thread of a non-blocking transport. The response is never held
+  // in memory as a whole.
+  StreamOutput imageSegmentation(const Args& args, const ImageSegmentationArgs& other_args,
+                                 ResultSink<ImageSegmentationResult> result_sink,
+                                 const Options& options = Options()) const {
+    ExtendedOptions extended_options(options);
+    extended_options.binary = true;
+    return requestStream(makeCall(args, other_args, extended_options, other_args.data),
+                         std::make_shared<ResultStreamDecoder<ImageSegmentationResult>>(std::move(result_sink)));
+  }
+
   std::string textToImage(const Args& args, const TextToImageArgs& other_args,
                           const Options& options = Options()) const {
     ExtendedOptions extended_options(options);
@@ -146,139 +647,1076 @@ class HfInference {
     return request(args, other_args, extended_options);
   }
 
+  std::future<std::string> textToImageAsync(const Args& args, const TextToImageArgs& other_args,
+                                            const Options& options = Options()) const {
+    ExtendedOptions extended_options(options);
+    extended_options.blob = true;
+    return requestAsync(args, other_args, extended_options);
+  }
+
+  void textToImageAsync(const Args& args, const TextToImageArgs& other_args,
+                        OutputCallback callback, const Options& options = Options()) const {
+    ExtendedOptions extended_options(options);
+    extended_options.blob = true;
+    requestAsync(args, other_args, extended_options, std::move(callback));
+  }
+
+  // Writes the image to `output_file_path` instead of the path set by `setOutputFilePath()`, so that concurrent
+  // calls do not overwrite each other's output.
+  std::string textToImage(const Args& args, const TextToImageArgs& other_args,
+                          const std::filesystem::path& output_file_path, const Options& options = Options()) const {
+    ExtendedOptions extended_options(options);
+    extended_options.blob = true;
+    auto call = makeCall(args, other_args, extended_options);
+    call->output_file_path = output_file_path;
+    return request(call);
+  }
+
+  // Returns the image in memory instead of writing it to a file.
+  BlobOutput textToImageBytes(const Args& args, const TextToImageArgs& other_args,
+                              const Options& options = Options()) const {
+    ExtendedOptions extended_options(options);
+    extended_options.blob = true;
+    auto call = makeCall(args, other_args, extended_options);
+    call->output_target = OutputTarget::kMemory;
+    std::string output_string = request(call);
+    return BlobOutput{call->response_code, std::move(output_string)};
+  }
+
+  // Streams the image into `blob_sink` as it arrives, on the calling thread or on an I/O thread of a non-blocking
+  // transport. If the call fails, `blob_sink` is not invoked and the error is returned in `BlobOutput::data`.
+  BlobOutput textToImage(const Args& args, const TextToImageArgs& other_args, BlobSink blob_sink,
+                         const Options& options = Options()) const {
+    ExtendedOptions extended_options(options);
+    extended_options.blob = true;
+    auto call = makeCall(args, other_args, extended_options);
+    call->output_target = OutputTarget::kSink;
+    call->output_sink = std::move(blob_sink);
+    std::string output_string = request(call);
+    return BlobOutput{call->response_code, std::move(output_string)};
+  }
+
+  // Same as the methods above, but decode the output string into typed results. The output string is moved into
+  // `Result::error` if it is not a result, e.g. an error.
+  Result<std::vector<FillMaskResult>> fillMaskTyped(const Args& args, const FillMaskArgs& other_args,
+                                                    const Options& options = Options()) const {
+    return parseResult<std::vector<FillMaskResult>>(fillMask(args, other_args, options));
+  }
+
+  Result<std::vector<SummarizationResult>> summarizationTyped(const Args& args, const SummarizationArgs& other_args,
+                                                              const Options& options = Options()) const {
+    return parseResult<std::vector<SummarizationResult>>(summarization(args, other_args, options));
+  }
+
+  Result<QuestionAnswerResult> questionAnswerTyped(const Args& args, const QuestionAnswerArgs& other_args,
+                                                   const Options& options = Options()) const {
+    return parseResult<QuestionAnswerResult>(questionAnswer(args, other_args, options));
+  }
+
+  Result<TableQuestionAnswerResult> tableQuestionAnswerTyped(
+      const Args& args, const TableQuestionAnswerArgs& other_args, const Options& options = Options()) const {
+    return parseResult<TableQuestionAnswerResult>(tableQuestionAnswer(args, other_args, options));
+  }
+
+  Result<std::vector<TextClassificationResult>> textClassificationTyped(
+      const Args& args, const TextClassificationArgs& other_args, const Options& options = Options()) const {
+    // The output has one list of labels per input.
+    Result<std::vector<std::vector<TextClassificationResult>>> nested_result =
+        parseResult<std::vector<std::vector<TextClassificationResult>>>(textClassification(args, other_args, options));
+    Result<std::vector<TextClassificationResult>> result;
+    if (!nested_result.value_opt.has_value()) {
+      result.error = std::move(nested_result.error);
+    } else if (!nested_result.value_opt->empty()) {
+      result.value_opt = std::move(nested_result.value_opt->front());
+    } else {
+      result.value_opt.emplace();
+    }
+    return result;
+  }
+
+  Result<std::vector<TextGenerationResult>> textGenerationTyped(const Args& args, const TextGenerationArgs& other_args,
+                                                                const Options& options = Options()) const {
+    return parseResult<std::vector<TextGenerationResult>>(textGeneration(args, other_args, options));
+  }
+
+  Result<std::vector<TokenClassificationResult>> tokenClassificationTyped(
+      const Args& args, const TokenClassificationArgs& other_args, const Options& options = Options()) const {
+    return parseResult<std::vector<TokenClassificationResult>>(tokenClassification(args, other_args, options));
+  }
+
+  Result<std::vector<TranslationResult>> translationTyped(const Args& args, const TranslationArgs& other_args,
+                                                          const Options& options = Options()) const {
+    return parseResult<std::vector<TranslationResult>>(translation(args, other_args, options));
+  }
+
+  Result<std::vector<ZeroShotClassificationResult>> zeroShotClassificationTyped(
+      const Args& args, const ZeroShotClassificationArgs& other_args, const Options& options = Options()) const {
+    return parseResult<std::vector<ZeroShotClassificationResult>>(zeroShotClassification(args, other_args, options));
+  }
+
+  Result<ConversationalResult> conversationalTyped(const Args& args, const ConversationalArgs& other_args,
+                                                   const Options& options = Options()) const {
+    return parseResult<ConversationalResult>(conversational(args, other_args, options));
+  }
+
+  Result<AutomaticSpeechRecognitionResult> automaticSpeechRecognitionTyped(
+      const Args& args, const AutomaticSpeechRecognitionArgs& other_args, const Options& options = Options()) const {
+    return parseResult<AutomaticSpeechRecognitionResult>(automaticSpeechRecognition(args, other_args, options));
+  }
+
+  Result<std::vector<AudioClassificationResult>> audioClassificationTyped(
+      const Args& args, const AudioClassificationArgs& other_args, const Options& options = Options()) const {
+    return parseResult<std::vector<AudioClassificationResult>>(audioClassification(args, other_args, options));
+  }
+
+  Result<std::vector<ImageClassificationResult>> imageClassificationTyped(
+      const Args& args, const ImageClassificationArgs& other_args, const Options& options = Options()) const {
+    return parseResult<std::vector<ImageClassificationResult>>(imageClassification(args, other_args, options));
+  }
+
+  Result<std::vector<ObjectDetectionResult>> objectDetectionTyped(
+      const Args& args, const ObjectDetectionArgs& other_args, const Options& options = Options()) const {
+    return parseResult<std::vector<ObjectDetectionResult>>(objectDetection(args, other_args, options));
+  }
+
+  Result<std::vector<ImageSegmentationResult>> imageSegmentationTyped(
+      const Args& args, const ImageSegmentationArgs& other_args, const Options& options = Options()) const {
+    return parseResult<std::vector<ImageSegmentationResult>>(imageSegmentation(args, other_args, options));
+  }
+
  private:
+  template <typename R>
+  Result<R> parseResult(std::string output_string) const {
+    TraceScope trace_scope(tracer_.get(), "parse");
+    return ParseResult<R>(std::move(output_string));
+  }
+
+  // Where the output of a call goes. By default, blob outputs are written to a file, and the others are returned in
+  // memory.
+  enum class OutputTarget {
+    kFile,
+    kMemory,
+    kSink,
+  };
+
+  // The state of one call, carried from `perform()` through the transport to `complete()`.
+  template <typename T>
+  struct Call {
+    Args args;
+    T other_args;
+    ExtendedOptions extended_options;
+    std::filesystem::path input_file_path;
+    OutputCallback callback;
+
+    OutputTarget output_target = OutputTarget::kFile;
+    std::filesystem::path output_file_path;  // For `OutputTarget::kFile`.
+    BlobSink output_sink;                    // For `OutputTarget::kSink`. Receives a successful response body.
+    long response_code = 0;                  // Set before `callback` is invoked, 200 if served from the cache.
+
+    std::shared_ptr<std::ofstream> output_file_stream;
+    std::optional<CacheKey> cache_key_opt;  // Set if the response may be served from and stored in the cache.
+    bool is_flight_leader = false;
+
+    std::shared_ptr<Transport> transport;  // Set on the first attempt, and kept by the retries.
+    std::shared_ptr<RateLimiter> rate_limiter;  // Same.
+    std::shared_ptr<ConcurrencyLimiter> concurrency_limiter;  // Same.
+    std::shared_ptr<Scheduler> scheduler;  // Same.
+    std::shared_ptr<RequestMetrics::Series> metrics_series;  // Same.
+    std::size_t num_attempts = 0;
+    std::chrono::steady_clock::time_point first_attempt_time;
+    std::chrono::steady_clock::time_point send_time;  // Of the current attempt, once it holds its concurrency slot.
+    std::optional<std::chrono::milliseconds> retry_delay_opt;  // Set when a blocking transport has to retry.
+    bool is_output_delivered = false;  // Whether `output_sink` has received a part of the response.
+    bool has_scheduler_slot = false;  // Between the grant of a scheduler slot and the completion of the attempt.
+
+    // Holds the JSON body of the current attempt, which the request refers to. Returned to the pool with the call.
+    BufferPool::Handle body_buffer;
+    BufferPool::Handle compressed_body_buffer;  // Holds the body compressed per `CompressionPolicy`, if it is.
+
+    std::shared_ptr<Tracer> tracer;  // Set when the call is made, if tracing.
+    std::uint64_t trace_id = 0;
+    std::chrono::steady_clock::time_point make_time;
+    std::chrono::steady_clock::time_point admission_time;  // When the current attempt starts waiting to be sent.
+  };
+
   template <typename T>
   std::string request(const Args& args, const T& other_args, const ExtendedOptions& extended_options,
                       const std::filesystem::path& input_file_path = std::filesystem::path()) const {
-    std::future<std::string> output_string_ftr = std::async(std::launch::async, [&]() mutable {
+    return request(makeCall(args, other_args, extended_options, input_file_path));
+  }
+
+  // Waits on the stack rather than on a `std::promise`, whose shared state would be allocated for every call.
+  template <typename T>
+  std::string request(const std::shared_ptr<Call<T>>& call) const {
+    struct OutputWaiter {
+      std::mutex mutex;
+      std::condition_variable condition;
+      std::optional<std::string> output_string_opt;
+    } output_waiter;
+
+    call->callback = [&output_waiter](std::string output_string) {
+      // Notifies under the lock, since the waiter is destroyed as soon as the wait returns.
+      std::lock_guard<std::mutex> lock(output_waiter.mutex);
+      output_waiter.output_string_opt = std::move(output_string);
+      output_waiter.condition.notify_one();
+    };
+    perform(call);
+
+    std::unique_lock<std::mutex> lock(output_waiter.mutex);
+    output_waiter.condition.wait(lock, [&output_waiter]() { return output_waiter.output_string_opt.has_value(); });
+    return std::move(output_waiter.output_string_opt.value());
+  }
+
+  // Feeds the successful response body to `decoder` (e.g. a `ResultStreamDecoder`) chunk by chunk instead of
+  // accumulating it.
+  template <typename T, typename Decoder>
+  StreamOutput requestStream(const std::shared_ptr<Call<T>>& call, const std::shared_ptr<Decoder>& decoder) const {
+    call->output_target = OutputTarget::kSink;
+    call->output_sink = [decoder](const char* data, std::size_t size) {
+      decoder->feed(data, size);
+    };
+    std::string output_string = request(call);
+
+    StreamOutput stream_output{call->response_code, decoder->numResults()};
+    const bool is_successful = 200 <= call->response_code && call->response_code < 300;
+    if (!is_successful) {
+      stream_output.error = std::move(output_string);
+    } else if (!decoder->finish()) {
+      stream_output.error = decoder->error();
+    }
+    return stream_output;
+  }
+
+  // Runs `requestStream()` with an `EventStreamDecoder` on the thread pool, and hands the results over through the
+  // returned stream.
+  template <typename R, typename T>
+  ResultStream<R> requestStreamAsync(const Args& args, const T& other_args, const ExtendedOptions& extended_options,
+                                     const StreamOptions& stream_options) const {
+    auto channel = std::make_shared<typename ResultStream<R>::Channel>(stream_options.max_buffered_results);
+
+    thread_pool_->post([this, args, other_args, extended_options, channel]() {
+      auto decoder = std::make_shared<EventStreamDecoder<R>>([channel](R result) {
+        channel->push(std::move(result));
+      });
       try {
-        curlpp::Cleanup curlpp_cleanup;
-        curlpp::Easy curlpp_request;
+        channel->close(requestStream(makeCall(args, other_args, extended_options), decoder));
+      }
+      catch (const std::exception& e) {
+        const nlohmann::json std_exception_json{
+            {"std_exception", e.what()},
+        };
+        channel->close(StreamOutput{0, decoder->numResults(), std_exception_json.dump()});
+      }
+    });
+
+    return ResultStream<R>(channel);
+  }
+
+  template <typename T>
+  std::future<std::string> requestAsync(const Args& args, const T& other_args, const ExtendedOptions& extended_options,
+                                        const std::filesystem::path& input_file_path = std::filesystem::path()) const {
+    auto output_string_promise = std::make_shared<std::promise<std::string>>();
+    std::future<std::string> output_string_ftr = output_string_promise->get_future();
+
+    thread_pool_->post([this, args, other_args, extended_options, input_file_path, output_string_promise]() {
+      try {
+        perform(args, other_args, extended_options, input_file_path,
+                [output_string_promise](std::string output_string) {
+                  output_string_promise->set_value(std::move(output_string));
+                });
+      }
+      catch (...) {
+        output_string_promise->set_exception(std::current_exception());
+      }
+    });
+
+    return output_string_ftr;
+  }
+
+  template <typename T>
+  void requestAsync(const Args& args, const T& other_args, const ExtendedOptions& extended_options,
+                    OutputCallback callback,
+                    const std::filesystem::path& input_file_path = std::filesystem::path()) const {
+    thread_pool_->post([this, args, other_args, extended_options, input_file_path, callback = std::move(callback)]() {
+      performNoThrow(args, other_args, extended_options, input_file_path, callback);
+    });
+  }
+
+  // Splits `inputs` into chunks limited by `batch_options`, sends them concurrently on the thread pool, and returns
+  // one output string per input in input order. Must not be called from a worker thread of the thread pool.
+  template <typename T>
+  std::vector<std::string> requestBatch(const Args& args, const T& other_args, const std::vector<std::string>& inputs,
+                                        const ExtendedOptions& extended_options,
+                                        const BatchOptions& batch_options) const {
+    std::vector<std::size_t> chunk_begins;
+    std::size_t chunk_bytes = 0;
+    for (std::size_t i = 0; i < inputs.size(); ++i) {
+      const bool is_chunk_full = chunk_begins.empty() ||
+                                 batch_options.max_batch_size <= i - chunk_begins.back() ||
+                                 batch_options.max_batch_bytes < chunk_bytes + inputs[i].size();
+      if (is_chunk_full) {
+        chunk_begins.push_back(i);
+        chunk_bytes = 0;
+      }
+      chunk_bytes += inputs[i].size();
+    }
+    chunk_begins.push_back(inputs.size());
+
+    std::vector<std::future<std::string>> output_string_ftrs;
+    for (std::size_t chunk = 0; chunk + 1 < chunk_begins.size(); ++chunk) {
+      BatchArgs<T> batch_args{other_args, std::vector<std::string>(inputs.begin() + chunk_begins[chunk],
+                                                                   inputs.begin() + chunk_begins[chunk + 1])};
+      output_string_ftrs.push_back(requestAsync(args, batch_args, extended_options));
+    }
+
+    std::vector<std::string> output_strings(inputs.size());
+    for (std::size_t chunk = 0; chunk + 1 < chunk_begins.size(); ++chunk) {
+      const std::size_t chunk_size = chunk_begins[chunk + 1] - chunk_begins[chunk];
+      const std::string output_string = output_string_ftrs[chunk].get();
+
+      // The response is an array with one element per input. Anything else (e.g. an error object) is reported as
+      // the output of every input of the chunk.
+      const nlohmann::json output_json = nlohmann::json::parse(output_string, nullptr, false);
+      const bool is_batched_output = output_json.is_array() && output_json.size() == chunk_size;
+      for (std::size_t i = 0; i < chunk_size; ++i) {
+        output_strings[chunk_begins[chunk] + i] = is_batched_output ? output_json[i].dump() : output_string;
+      }
+    }
+
+    return output_strings;
+  }
+
+  // Blob outputs go to the path set by `setOutputFilePath()` at the time of the call, unless overridden.
+  template <typename T>
+  std::shared_ptr<Call<T>> makeCall(const Args& args, const T& other_args, const ExtendedOptions& extended_options,
+                                    const std::filesystem::path& input_file_path = std::filesystem::path(),
+                                    OutputCallback callback = OutputCallback()) const {
+    auto call = std::make_shared<Call<T>>(Call<T>{args, other_args, extended_options, input_file_path,
+                                                  std::move(callback)});
+    call->output_file_path = output_file_path_;
+    if (tracer_) {
+      call->tracer = tracer_;
+      call->trace_id = tracer_->newCallId();
+      call->make_time = std::chrono::steady_clock::now();
+    }
+    return call;
+  }
+
+  // Builds the HTTP request and hands it to the transport. `callback` receives the output string once the transfer
+  // has completed, either on the calling thread (blocking transport) or on an I/O thread (non-blocking transport).
+  template <typename T>
+  void perform(const Args& args, const T& other_args, const ExtendedOptions& extended_options,
+               const std::filesystem::path& input_file_path, OutputCallback callback) const {
+    perform(makeCall(args, other_args, extended_options, input_file_path, std::move(callback)));
+  }
+
+  // A blocking transport completes the attempt before `Transport::perform()` returns, so its retries are made by this
+  // loop once their backoff has elapsed. The retries of a non-blocking transport are scheduled on the retry timer.
+  template <typename T>
+  void perform(const std::shared_ptr<Call<T>>& call) const {
+    performAttempt(call);
+    while (call->retry_delay_opt.has_value()) {
+      std::this_thread::sleep_for(std::exchange(call->retry_delay_opt, std::nullopt).value());
+      performAttempt(call);
+    }
+  }
+
+  template <typename T>
+  void performAttempt(const std::shared_ptr<Call<T>>& call) const {
+    const ExtendedOptions& extended_options = call->extended_options;
+    if (IsPastDeadline(*call)) {
+      expire(call);
+      return;
+    }
+    HttpRequest http_request;
+
+    // Headers.
+    http_request.headers = header_lists_[HeaderListIndex(extended_options.binary, extended_options.wait_for_model,
+                                                         extended_options.stream)];
+    http_request.accept_encoding =
+        extended_options.compression_policy.accept_encoded_responses && !extended_options.stream;
 
-        // Headers.
-        std::list<std::string> headers;
-        if (!api_key_.empty()) {
-          headers.push_back("Authorization: Bearer " + api_key_);
+    // URL.
+    http_request.url.reserve(endpoint_.size() + call->args.model.size());
+    http_request.url += endpoint_;
+    http_request.url += call->args.model;
+
+    try {
+      // Body. A JSON body is written into a pooled buffer, which keeps its capacity from the previous calls.
+      if (extended_options.binary) {
+        TraceScope trace_scope(call->tracer.get(), "read_input", call->trace_id);
+        http_request.body = MakeBodyFromBinaryInput(call->other_args, call->input_file_path);
+      } else {
+        TraceScope trace_scope(call->tracer.get(), "serialize", call->trace_id);
+        if (!call->body_buffer) {
+          call->body_buffer = body_buffer_pool_->acquire();
         }
-        if (!extended_options.binary) {
-          headers.push_back("Content-Type: application/json");
+        std::string& body = call->body_buffer.str();
+        body.clear();
+        AppendBodyFromJson(body, call->other_args, extended_options);
+        http_request.body = RequestBody::FromBuffer(body);
+      }
+
+      // Cache.
+      {
+        TraceScope trace_scope(call->tracer.get(), "cache_lookup", call->trace_id);
+        if (lookUpCaches(call, http_request.url, http_request.body.view())) {
+          return;
         }
-        if (extended_options.binary && extended_options.wait_for_model) {
-          headers.push_back("X-Wait-For-Model: true");
+      }
+
+      // Coalescing.
+      if (joinFlight(call, http_request)) {
+        return;
+      }
+
+      // Compression. Comes after the cache and the coalescing, which key on the uncompressed body.
+      const CompressionPolicy& compression_policy = extended_options.compression_policy;
+      if (!extended_options.binary && compression_policy.request_encoding != ContentEncoding::kIdentity &&
+          compression_policy.min_request_bytes <= http_request.body.size()) {
+        TraceScope trace_scope(call->tracer.get(), "compress", call->trace_id);
+        if (!call->compressed_body_buffer) {
+          call->compressed_body_buffer = body_buffer_pool_->acquire();
         }
-        curlpp_request.setOpt(new curlpp::options::HttpHeader(headers));
-
-        // URL.
-        curlpp_request.setOpt(new curlpp::options::Url("https://api-inference.huggingface.co/models/" + args.model));
-
-        // Body.
-        const std::string body = extended_options.binary ? MakeBodyFromFile(input_file_path)
-                                                         : MakeBodyFromJson(other_args, extended_options);
-        curlpp_request.setOpt(new curlpp::options::PostFields(body));
-        curlpp_request.setOpt(new curlpp::options::PostFieldSize(body.size()));
-
-        /*
-        extended_options.binary ? (std::cout << "body.size() = " << body.size() << std::endl << std::endl)
-                                : (std::cout << "body = " << body << std::endl << std::endl);
-        curlpp_request.setOpt(new curlpp::options::Verbose(true));
-        */
-
-        // Output.
-        std::ofstream output_file_stream;
-        std::ostringstream output_string_stream;
-        if (extended_options.blob) {
-          std::filesystem::create_directories(output_file_path_.parent_path());
-          output_file_stream.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-          output_file_stream.open(output_file_path_, std::ios::out | std::ios::binary);
-          curlpp_request.setOpt(new curlpp::options::WriteStream(&output_file_stream));
-        } else {
-          curlpp_request.setOpt(new curlpp::options::WriteStream(&output_string_stream));
+        std::string& compressed_body = call->compressed_body_buffer.str();
+        if (CompressBody(http_request.body.view(), compression_policy.request_encoding, compression_policy.level,
+                         compressed_body)) {
+          http_request.body = RequestBody::FromBuffer(compressed_body);
+          http_request.headers = header_lists_[HeaderListIndex(extended_options.binary, extended_options.wait_for_model,
+                                                               extended_options.stream,
+                                                               compression_policy.request_encoding)];
         }
+      }
 
-        // Performs the curlpp request.
-        curlpp_request.perform();
+      // Output. A blob returned in memory is accumulated into the response body.
+      if (extended_options.blob && call->output_target == OutputTarget::kFile) {
+        std::filesystem::create_directories(call->output_file_path.parent_path());
+        auto output_file_stream = std::make_shared<std::ofstream>();
+        output_file_stream->exceptions(std::ifstream::failbit | std::ifstream::badbit);
+        output_file_stream->open(call->output_file_path, std::ios::out | std::ios::binary);
+        http_request.on_data = [output_file_stream](const char* data, std::size_t size) {
+          output_file_stream->write(data, size);
+        };
+        call->output_file_stream = output_file_stream;
+      }
+      if (call->output_target == OutputTarget::kSink) {
+        http_request.on_data = [call](const char* data, std::size_t size) {
+          call->is_output_delivered = true;
+          call->output_sink(data, size);
+        };
+      }
+    }
+    catch (const std::fstream::failure& e) {
+      const nlohmann::json std_fstream_failure_json{
+          {"std_fstream_failure", "Exception opening/reading/writing/closing file."},
+      };
+      call->callback(std_fstream_failure_json.dump());
+      return;
+    }
 
-        // If the output type is file, then performs the post process.
-        if (extended_options.blob) {
-          output_file_stream.close();
-          const nlohmann::json output_file_path_json{
-            {"output_file_path", output_file_path_.string()},
-          };
-          output_string_stream << output_file_path_json.dump();
-        }
+    /*
+    extended_options.binary ? (std::cout << "body.size() = " << http_request.body.size() << std::endl << std::endl)
+                            : (std::cout << "body = " << http_request.body.view() << std::endl << std::endl);
+    */
 
-        // If the response code is a 503 error, then retries again with waiting for the model to be ready.
-        const long response_code = curlpp::infos::ResponseCode::get(curlpp_request);
-        if (extended_options.retry_on_error && response_code == 503 && !extended_options.wait_for_model) {
-          std::cerr << "Received " << response_code << ", retry on error..." << std::endl;
-          ExtendedOptions new_extended_options = extended_options;
-          new_extended_options.wait_for_model = true;
-          return request(args, other_args, new_extended_options, input_file_path);
+    if (call->num_attempts == 0) {
+      call->transport = transport_;
+      call->rate_limiter = rate_limiter_;
+      call->concurrency_limiter = concurrency_limiter_;
+      call->scheduler = scheduler_;
+      if (request_metrics_) {
+        call->metrics_series = request_metrics_->series(call->args.model, kTaskName<T>);
+      }
+      call->first_attempt_time = std::chrono::steady_clock::now();
+      if (extended_options.retry_policy.budget) {
+        extended_options.retry_policy.budget->recordFirstAttempt();
+      }
+    }
+    ++call->num_attempts;
+    if (call->tracer) {
+      call->admission_time = std::chrono::steady_clock::now();
+    }
+
+    // Waits for the rate limits: on the calling thread with a blocking transport, or on the timer otherwise.
+    const std::chrono::steady_clock::duration throttle_delay =
+        call->rate_limiter ? call->rate_limiter->reserve(call->args.model) : std::chrono::steady_clock::duration::zero();
+    if (0 < throttle_delay.count() && !call->transport->isBlocking()) {
+      retry_timer_->schedule(std::chrono::ceil<std::chrono::milliseconds>(throttle_delay),
+                             [this, call, http_request = std::move(http_request)]() mutable {
+                               admit(call, std::move(http_request));
+                             });
+      return;
+    }
+    std::this_thread::sleep_for(throttle_delay);
+    admit(call, std::move(http_request));
+  }
+
+  // Waits for a slot of the concurrency limiter, then sends the request: on the calling thread with a blocking
+  // transport, or else on the thread of the call that frees the slot.
+  template <typename T>
+  void admit(const std::shared_ptr<Call<T>>& call, HttpRequest http_request) const {
+    if (call->scheduler && !call->has_scheduler_slot) {
+      schedule(call, std::move(http_request));
+      return;
+    }
+    if (!call->concurrency_limiter) {
+      send(call, std::move(http_request));
+      return;
+    }
+    if (call->transport->isBlocking()) {
+      call->concurrency_limiter->acquire(call->args.model);
+      send(call, std::move(http_request));
+      return;
+    }
+    call->concurrency_limiter->acquire(call->args.model,
+                                       [this, call, http_request = std::move(http_request)]() mutable {
+                                         send(call, std::move(http_request));
+                                       });
+  }
+
+  // Waits for a slot of the scheduler, then admits the request, unless the deadline of the call passes first: on the
+  // calling thread with a blocking transport, or else on the thread that frees the slot, or on the timer.
+  template <typename T>
+  void schedule(const std::shared_ptr<Call<T>>& call, HttpRequest http_request) const {
+    const SchedulingPolicy& scheduling_policy = call->extended_options.scheduling_policy;
+    const std::string& tenant = scheduling_policy.tenant.empty() ? call->args.model : scheduling_policy.tenant;
+    if (call->transport->isBlocking()) {
+      if (!call->scheduler->acquire(scheduling_policy, tenant)) {
+        expire(call);
+        return;
+      }
+      call->has_scheduler_slot = true;
+      admit(call, std::move(http_request));
+      return;
+    }
+
+    // Otherwise, a waiting call is only dropped when another call requests or frees a slot.
+    if (scheduling_policy.deadline_opt.has_value()) {
+      const auto delay = std::chrono::ceil<std::chrono::milliseconds>(scheduling_policy.deadline_opt.value() -
+                                                                      std::chrono::steady_clock::now());
+      retry_timer_->schedule(std::max(delay, std::chrono::milliseconds(0)), [scheduler = call->scheduler]() {
+        scheduler->dropExpired();
+      });
+    }
+    call->scheduler->acquire(scheduling_policy, tenant,
+                             [this, call, http_request = std::move(http_request)](bool is_granted) mutable {
+                               if (!is_granted) {
+                                 expire(call);
+                                 return;
+                               }
+                               call->has_scheduler_slot = true;
+                               admit(call, std::move(http_request));
+                             });
+  }
+
+  template <typename T>
+  void releaseSchedulerSlot(const std::shared_ptr<Call<T>>& call) const {
+    if (call->has_scheduler_slot) {
+      call->has_scheduler_slot = false;
+      call->scheduler->release(call->extended_options.scheduling_policy.priority);
+    }
+  }
+
+  template <typename T>
+  static bool IsPastDeadline(const Call<T>& call) {
+    const std::optional<std::chrono::steady_clock::time_point>& deadline_opt =
+        call.extended_options.scheduling_policy.deadline_opt;
+    return deadline_opt.has_value() && deadline_opt.value() <= std::chrono::steady_clock::now();
+  }
+
+  // Fails a call whose deadline has passed before its request was sent.
+  template <typename T>
+  void expire(const std::shared_ptr<Call<T>>& call) const {
+    const nlohmann::json deadline_exceeded_json{
+        {"deadline_exceeded", "The deadline passed before the request was sent."},
+    };
+    call->callback(deadline_exceeded_json.dump());
+  }
+
+  template <typename T>
+  void send(const std::shared_ptr<Call<T>>& call, HttpRequest http_request) const {
+    if (IsPastDeadline(*call)) {
+      if (call->concurrency_limiter) {
+        call->concurrency_limiter->release(call->args.model, std::nullopt, false);
+      }
+      releaseSchedulerSlot(call);
+      expire(call);
+      return;
+    }
+    call->send_time = std::chrono::steady_clock::now();
+    if (call->tracer) {
+      call->tracer->recordAsyncSpan("queue", call->trace_id, call->admission_time, call->send_time);
+    }
+    if (call->extended_options.hedge_policy.enabled && !call->transport->isBlocking() && !http_request.on_data) {
+      sendHedged(call, std::move(http_request));
+      return;
+    }
+    call->transport->perform(std::move(http_request), [this, call](HttpResponse http_response) {
+      complete(call, std::move(http_response));
+    });
+  }
+
+  // The transfers of one hedged attempt: the original request, and its hedge once sent.
+  struct HedgedAttempt {
+    std::mutex mutex;
+    bool is_decided = false;  // Whether a response has won, or the attempt has failed.
+    std::size_t num_in_flight = 0;
+    std::vector<std::shared_ptr<Cancellation>> cancellations;
+  };
+
+  // Sends the request, and its hedge after the delay of the policy if no response has won by then.
+  template <typename T>
+  void sendHedged(const std::shared_ptr<Call<T>>& call, HttpRequest http_request) const {
+    const HedgePolicy& hedge_policy = call->extended_options.hedge_policy;
+    if (hedge_policy.budget) {
+      hedge_policy.budget->recordFirstAttempt();
+    }
+
+    // The losing transfer may outlive the call, so it must not read a buffer of the caller.
+    if (!http_request.body.ownsData()) {
+      http_request.body = RequestBody::FromString(std::string(http_request.body.view()));
+    }
+
+    auto hedged_attempt = std::make_shared<HedgedAttempt>();
+    sendHedgedTransfer(call, hedged_attempt, http_request, false);
+    retry_timer_->schedule(hedge_tracker_->delay(call->args.model, hedge_policy),
+                           [this, call, hedged_attempt, http_request = std::move(http_request)]() mutable {
+                             {
+                               std::lock_guard<std::mutex> lock(hedged_attempt->mutex);
+                               if (hedged_attempt->is_decided) {
+                                 return;
+                               }
+                             }
+                             const HedgePolicy& hedge_policy = call->extended_options.hedge_policy;
+                             if (hedge_policy.budget && !hedge_policy.budget->tryRetry()) {
+                               hedge_tracker_->recordRejectedHedge();
+                               return;
+                             }
+                             sendHedgedTransfer(call, hedged_attempt, std::move(http_request), true);
+                           });
+  }
+
+  template <typename T>
+  void sendHedgedTransfer(const std::shared_ptr<Call<T>>& call, const std::shared_ptr<HedgedAttempt>& hedged_attempt,
+                          HttpRequest http_request, bool is_hedge) const {
+    http_request.cancellation = std::make_shared<Cancellation>();
+    {
+      std::lock_guard<std::mutex> lock(hedged_attempt->mutex);
+      if (hedged_attempt->is_decided) {
+        return;
+      }
+      ++hedged_attempt->num_in_flight;
+      hedged_attempt->cancellations.push_back(http_request.cancellation);
+    }
+    if (is_hedge) {
+      hedge_tracker_->recordHedge();
+    }
+
+    const std::chrono::steady_clock::time_point send_time = std::chrono::steady_clock::now();
+    call->transport->perform(std::move(http_request), [this, call, hedged_attempt, is_hedge,
+                                                       send_time](HttpResponse http_response) {
+      const long response_code = http_response.response_code;
+      const bool is_usable = !http_response.exception_ptr && response_code < 500 && response_code != 429;
+      std::vector<std::shared_ptr<Cancellation>> cancellations;
+      {
+        std::lock_guard<std::mutex> lock(hedged_attempt->mutex);
+        --hedged_attempt->num_in_flight;
+        if (hedged_attempt->is_decided || (!is_usable && 0 < hedged_attempt->num_in_flight)) {
+          return;
         }
+        hedged_attempt->is_decided = true;
+        cancellations.swap(hedged_attempt->cancellations);
+      }
 
-        return output_string_stream.str();
+      for (const std::shared_ptr<Cancellation>& cancellation : cancellations) {
+        cancellation->cancel();
       }
-      catch (const std::fstream::failure& e) {
-        const nlohmann::json std_fstream_failure_json{
-            {"std_fstream_failure", "Exception opening/reading/writing/closing file."},
-        };
-        return std_fstream_failure_json.dump();
+      if (!http_response.exception_ptr) {
+        hedge_tracker_->recordLatency(call->args.model, std::chrono::steady_clock::now() - send_time);
       }
-      catch(const curlpp::RuntimeError& e) {
-        const nlohmann::json curlpp_runtime_error_json{
-            {"curlpp_runtime_error", e.what()},
-        };
-        return curlpp_runtime_error_json.dump();
+      if (is_hedge) {
+        hedge_tracker_->recordWonHedge();
       }
-      catch(const curlpp::LogicError& e) {
-        const nlohmann::json curlpp_logic_error_json{
-            {"curlpp_logic_error", e.what()},
+      complete(call, std::move(http_response));
+    });
+  }
+
+  // Retries the call after a backoff if the attempt failed transiently, and the policy, the deadline and the retry
+  // budget allow it. Returns whether the call will be retried.
+  template <typename T>
+  bool scheduleRetry(const std::shared_ptr<Call<T>>& call, const HttpResponse& http_response) const {
+    ExtendedOptions& extended_options = call->extended_options;
+    const RetryPolicy& retry_policy = extended_options.retry_policy;
+    if (!extended_options.retry_on_error || retry_policy.max_attempts <= call->num_attempts) {
+      return false;
+    }
+
+    const long response_code = http_response.response_code;
+    if (http_response.exception_ptr) {
+      if (call->is_output_delivered || !IsRetryableFailure(http_response.exception_ptr, retry_policy)) {
+        return false;
+      }
+    } else if (std::find(retry_policy.retryable_response_codes.begin(), retry_policy.retryable_response_codes.end(),
+                         response_code) == retry_policy.retryable_response_codes.end()) {
+      return false;
+    }
+
+    // The server may tell how long to wait, e.g. with a 429 or a 503.
+    const std::chrono::milliseconds retry_delay =
+        std::max(RetryBackoff(retry_policy, call->num_attempts),
+                 http_response.retry_after_opt.value_or(std::chrono::milliseconds(0)));
+    const std::optional<std::chrono::steady_clock::time_point>& deadline_opt =
+        extended_options.scheduling_policy.deadline_opt;
+    const bool is_past_deadline =
+        (0 < retry_policy.deadline.count() &&
+         call->first_attempt_time + retry_policy.deadline < std::chrono::steady_clock::now() + retry_delay) ||
+        (deadline_opt.has_value() && deadline_opt.value() < std::chrono::steady_clock::now() + retry_delay);
+    if (is_past_deadline || (retry_policy.budget && !retry_policy.budget->tryRetry())) {
+      return false;
+    }
+
+    // A 503 is typically returned while the model is loading, which the server can wait for instead.
+    if (response_code == 503) {
+      extended_options.wait_for_model = true;
+    }
+
+    std::cerr << (http_response.exception_ptr ? "Transfer failed" : "Received " + std::to_string(response_code))
+              << ", retry on error in " << retry_delay.count() << " ms..." << std::endl;
+    if (call->transport->isBlocking()) {
+      call->retry_delay_opt = retry_delay;
+    } else {
+      retry_timer_->schedule(retry_delay, [this, call]() {
+        performNoThrow(call);
+      });
+    }
+    return true;
+  }
+
+  static bool IsRetryableFailure(const std::exception_ptr& exception_ptr, const RetryPolicy& retry_policy) {
+    try {
+      std::rethrow_exception(exception_ptr);
+    }
+    catch (const curlpp::LibcurlRuntimeError& e) {
+      return std::find(retry_policy.retryable_curl_codes.begin(), retry_policy.retryable_curl_codes.end(),
+                       e.whatCode()) != retry_policy.retryable_curl_codes.end();
+    }
+    catch (...) {
+      return false;
+    }
+  }
+
+  // Serves the call from the in-memory cache, then from the disk cache. Returns whether the callback has been invoked.
+  // Otherwise, sets `Call::cache_key_opt` if the response should be stored once received.
+  template <typename T>
+  bool lookUpCaches(const std::shared_ptr<Call<T>>& call, std::string_view url, std::string_view body) const {
+    const ExtendedOptions& extended_options = call->extended_options;
+    if (!extended_options.use_cache) {
+      return false;
+    }
+
+    if (extended_options.blob) {
+      // Blob outputs are only stored on disk. The Inference API itself serves them from its cache with `use_cache`.
+      if (!disk_cache_ || !disk_cache_config_.cache_blobs) {
+        return false;
+      }
+      call->cache_key_opt = MakeCacheKey(url, body);
+      const std::optional<std::filesystem::path> blob_path_opt = disk_cache_->getBlob(call->cache_key_opt.value());
+      if (!blob_path_opt.has_value()) {
+        return false;
+      }
+      call->response_code = 200;
+      if (call->output_target == OutputTarget::kFile) {
+        std::filesystem::create_directories(call->output_file_path.parent_path());
+        std::filesystem::copy_file(blob_path_opt.value(), call->output_file_path,
+                                   std::filesystem::copy_options::overwrite_existing);
+        const nlohmann::json output_file_path_json{
+          {"output_file_path", call->output_file_path.string()},
         };
-        return curlpp_logic_error_json.dump();
+        call->callback(output_file_path_json.dump());
+        return true;
       }
-    });
 
-    output_string_ftr.wait();
+      std::ifstream blob_file_stream;
+      blob_file_stream.exceptions(std::ifstream::failbit | std::ifstream::badbit);
+      blob_file_stream.open(blob_path_opt.value(), std::ios::in | std::ios::binary);
+      std::string blob((std::istreambuf_iterator<char>(blob_file_stream)), std::istreambuf_iterator<char>());
+      if (call->output_target == OutputTarget::kSink) {
+        call->output_sink(blob.data(), blob.size());
+        blob.clear();
+      }
+      call->callback(std::move(blob));
+      return true;
+    }
+
+    if ((!response_cache_ && !disk_cache_) || !IsCacheable(call->other_args)) {
+      return false;
+    }
+    call->cache_key_opt = MakeCacheKey(url, body);
 
-    return output_string_ftr.get();
+    std::optional<std::string> output_string_opt;
+    if (response_cache_) {
+      output_string_opt = response_cache_->get(call->cache_key_opt.value());
+    }
+    if (!output_string_opt.has_value() && disk_cache_) {
+      output_string_opt = disk_cache_->get(call->cache_key_opt.value());
+      if (output_string_opt.has_value() && response_cache_) {
+        response_cache_->put(call->cache_key_opt.value(), output_string_opt.value());
+      }
+    }
+    if (!output_string_opt.has_value()) {
+      return false;
+    }
+
+    call->response_code = 200;
+    if (call->output_target == OutputTarget::kSink) {
+      call->output_sink(output_string_opt->data(), output_string_opt->size());
+      output_string_opt->clear();
+    }
+    call->callback(std::move(output_string_opt.value()));
+    return true;
   }
 
+  // Joins the in-flight call with the same URL, headers and body, if any. Returns whether the call has become a
+  // follower. Otherwise, the call leads the flight and its callback also completes the followers.
   template <typename T>
-  std::string MakeBodyFromJson(const T& other_args, const ExtendedOptions& extended_options) const {
-    // Composes a JSON object.
-    nlohmann::json body_json = other_args;
-    body_json["options"] = extended_options;
+  bool joinFlight(const std::shared_ptr<Call<T>>& call, const HttpRequest& http_request) const {
+    // File and sink outputs cannot be shared, and retries of a leader keep leading the same flight.
+    if (!single_flight_ || call->extended_options.blob || call->output_target == OutputTarget::kSink ||
+        call->is_flight_leader) {
+      return false;
+    }
 
-    // Converts to `std::string` type.
-    const std::string body = body_json.dump();
+    std::string key_prefix = http_request.url;
+    for (const std::string& header : http_request.headers->headers()) {
+      key_prefix += '\n' + header;
+    }
+    const CacheKey flight_key = MakeCacheKey(key_prefix, http_request.body.view());
+    if (!single_flight_->join(flight_key, call->callback)) {
+      return true;
+    }
 
-    return body;
+    call->is_flight_leader = true;
+    call->callback = [single_flight = single_flight_, flight_key,
+                      callback = std::move(call->callback)](std::string output_string) {
+      single_flight->complete(flight_key, output_string);
+      callback(std::move(output_string));
+    };
+    return false;
   }
 
-  std::string MakeBodyFromFile(const std::filesystem::path& input_file_path) const {
-    // Opens the input file.
-    std::ifstream input_file_stream;
-    input_file_stream.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-    input_file_stream.open(input_file_path, std::ios::in | std::ios::binary);
+  template <typename T>
+  void storeInCaches(const std::shared_ptr<Call<T>>& call, const std::string& output_string) const {
+    // An output streamed to a sink has not been kept, so it cannot be stored.
+    if (call->output_target == OutputTarget::kSink) {
+      return;
+    }
+    if (call->extended_options.blob) {
+      if (call->output_target == OutputTarget::kFile) {
+        disk_cache_->putBlob(call->cache_key_opt.value(), call->output_file_path);
+      } else {
+        disk_cache_->putBlobContents(call->cache_key_opt.value(), output_string);
+      }
+      return;
+    }
+    if (response_cache_) {
+      response_cache_->put(call->cache_key_opt.value(), output_string);
+    }
+    if (disk_cache_) {
+      disk_cache_->put(call->cache_key_opt.value(), output_string);
+    }
+  }
 
-    // Gets the input file size.
-    input_file_stream.seekg(0, std::ios::end);
-    const std::size_t input_file_size = input_file_stream.tellg();
-    input_file_stream.seekg(0, std::ios::beg);
+  // Same as `perform()`, but reports exceptions thrown while building the request through `callback`.
+  template <typename T>
+  void performNoThrow(const Args& args, const T& other_args, const ExtendedOptions& extended_options,
+                      const std::filesystem::path& input_file_path, OutputCallback callback) const {
+    performNoThrow(makeCall(args, other_args, extended_options, input_file_path, std::move(callback)));
+  }
 
-    // Reads the input file contents.
-    std::vector<char> body_chars(input_file_size / sizeof(char));
-    input_file_stream.read(static_cast<char*>(&body_chars[0]), input_file_size);
-    input_file_stream.close();
+  template <typename T>
+  void performNoThrow(const std::shared_ptr<Call<T>>& call) const {
+    try {
+      perform(call);
+    }
+    catch (const std::exception& e) {
+      const nlohmann::json std_exception_json{
+          {"std_exception", e.what()},
+      };
+      call->callback(std_exception_json.dump());
+    }
+  }
+
+  template <typename T>
+  void complete(const std::shared_ptr<Call<T>>& call, HttpResponse http_response) const {
+    if (call->tracer) {
+      call->tracer->recordAsyncSpan("transfer", call->trace_id, call->send_time, std::chrono::steady_clock::now());
+    }
+    releaseSchedulerSlot(call);
+    if (call->concurrency_limiter) {
+      const long response_code = http_response.response_code;
+      const bool is_overloaded =
+          !http_response.exception_ptr && (response_code == 429 || response_code == 503 || response_code == 504);
+      call->concurrency_limiter->release(
+          call->args.model,
+          http_response.exception_ptr ? std::nullopt
+                                      : std::make_optional(std::chrono::steady_clock::now() - call->send_time),
+          is_overloaded);
+    }
+    if (call->rate_limiter && !http_response.exception_ptr) {
+      if (http_response.response_code == 429) {
+        call->rate_limiter->onThrottled(call->args.model, http_response.retry_after_opt);
+      } else if (200 <= http_response.response_code && http_response.response_code < 300) {
+        call->rate_limiter->onSuccess(call->args.model);
+      }
+    }
+    if (call->metrics_series) {
+      call->metrics_series->recordTransfer(http_response);
+    }
+    if (scheduleRetry(call, http_response)) {
+      return;
+    }
+    if (call->metrics_series) {
+      call->metrics_series->recordCall(http_response.exception_ptr ? 0 : http_response.response_code,
+                                       call->num_attempts, std::chrono::steady_clock::now() - call->first_attempt_time);
+    }
+
+    const ExtendedOptions& extended_options = call->extended_options;
+    const std::chrono::steady_clock::time_point process_time =
+        call->tracer ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point();
+    std::string output_string;
+    try {
+      if (http_response.exception_ptr) {
+        std::rethrow_exception(http_response.exception_ptr);
+      }
+
+      // If the output type is file, then performs the post process. Error responses are returned as the output
+      // string instead, since they are not written to the file.
+      const long response_code = http_response.response_code;
+      call->response_code = response_code;
+      const bool is_successful = 200 <= response_code && response_code < 300;
+      if (extended_options.blob && call->output_target == OutputTarget::kFile && is_successful) {
+        call->output_file_stream->close();
+        const nlohmann::json output_file_path_json{
+          {"output_file_path", call->output_file_path.string()},
+        };
+        output_string = output_file_path_json.dump();
+      } else {
+        output_string = std::move(http_response.body);
+      }
+
+      if (call->cache_key_opt.has_value() && response_code == 200) {
+        storeInCaches(call, output_string);
+      }
+    }
+    catch (const std::fstream::failure& e) {
+      const nlohmann::json std_fstream_failure_json{
+          {"std_fstream_failure", "Exception opening/reading/writing/closing file."},
+      };
+      output_string = std_fstream_failure_json.dump();
+    }
+    catch(const curlpp::RuntimeError& e) {
+      const nlohmann::json curlpp_runtime_error_json{
+          {"curlpp_runtime_error", e.what()},
+      };
+      output_string = curlpp_runtime_error_json.dump();
+    }
+    catch(const curlpp::LogicError& e) {
+      const nlohmann::json curlpp_logic_error_json{
+          {"curlpp_logic_error", e.what()},
+      };
+      output_string = curlpp_logic_error_json.dump();
+    }
+    catch (const std::exception& e) {
+      // E.g. thrown by a `BlobSink`.
+      const nlohmann::json std_exception_json{
+          {"std_exception", e.what()},
+      };
+      output_string = std_exception_json.dump();
+    }
+
+    if (call->tracer) {
+      const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+      call->tracer->recordSpan("complete", call->trace_id, process_time, now);
+      call->tracer->recordAsyncSpan("call", call->trace_id, call->make_time, now);
+    }
+    call->callback(std::move(output_string));
+  }
+
+  // Sends the caller-owned `data_buffer` if set, or else maps the input file. Neither is copied.
+  template <typename T>
+  RequestBody MakeBodyFromBinaryInput(const T& other_args, const std::filesystem::path& input_file_path) const {
+    if constexpr (requires { other_args.data_buffer; }) {
+      if (!other_args.data_buffer.empty()) {
+        return RequestBody::FromBuffer(other_args.data_buffer);
+      }
+    }
+    return MakeBodyFromFile(input_file_path);
+  }
+
+  RequestBody MakeBodyFromFile(const std::filesystem::path& input_file_path) const {
+    return RequestBody::FromFile(input_file_path);
+  }
 
-    // Converts to `std::string` type.
-    const std::string body(body_chars.begin(), body_chars.end());
+  static constexpr std::size_t kNumHeaderLists = 2 * 2 * 2 * 3;
 
-    return body;
+  static std::size_t HeaderListIndex(bool binary, bool wait_for_model, bool stream,
+                                     ContentEncoding content_encoding = ContentEncoding::kIdentity) {
+    return (binary ? 1 : 0) | (wait_for_model ? 2 : 0) | (stream ? 4 : 0) |
+           (static_cast<std::size_t>(content_encoding) << 3);
   }
-  
+
+  // Builds the header lists for every combination of the options that set headers, so that the requests share them.
+  void makeHeaderLists() {
+    for (bool binary : {false, true}) {
+      for (bool wait_for_model : {false, true}) {
+        for (bool stream : {false, true}) {
+          for (ContentEncoding content_encoding :
+               {ContentEncoding::kIdentity, ContentEncoding::kGzip, ContentEncoding::kDeflate}) {
+            std::vector<std::string> headers;
+            if (!api_key_.empty()) {
+              headers.push_back("Authorization: Bearer " + api_key_);
+            }
+            if (!binary) {
+              headers.push_back("Content-Type: application/json");
+            }
+            if (binary && wait_for_model) {
+              headers.push_back("X-Wait-For-Model: true");
+            }
+            if (stream) {
+              headers.push_back("Accept: text/event-stream");
+            }
+            if (content_encoding != ContentEncoding::kIdentity) {
+              headers.push_back("Content-Encoding: " + std::string(ContentEncodingName(content_encoding)));
+            }
+            header_lists_[HeaderListIndex(binary, wait_for_model, stream, content_encoding)] =
+                std::make_shared<const HeaderList>(std::move(headers));
+          }
+        }
+      }
+    }
+  }
+
   std::string api_key_;
+  std::string endpoint_ = kDefaultEndpoint;
   std::filesystem::path output_file_path_;
+  std::shared_ptr<ConnectionPool> connection_pool_;
+  std::shared_ptr<Transport> transport_;
+  std::array<std::shared_ptr<const HeaderList>, kNumHeaderLists> header_lists_;  // Indexed by `HeaderListIndex()`.
+  std::shared_ptr<BufferPool> body_buffer_pool_;
+  std::shared_ptr<ResponseCache> response_cache_;
+  DiskCacheConfig disk_cache_config_;
+  std::shared_ptr<DiskCache> disk_cache_;
+  std::shared_ptr<SingleFlight> single_flight_;
+  std::shared_ptr<RateLimiter> rate_limiter_;
+  std::shared_ptr<ConcurrencyLimiter> concurrency_limiter_;
+  std::shared_ptr<Scheduler> scheduler_;
+  std::shared_ptr<RequestMetrics> request_metrics_;
+  std::shared_ptr<Tracer> tracer_;
+  std::shared_ptr<HedgeTracker> hedge_tracker_;
+  std::shared_ptr<RetryTimer> retry_timer_;
+
+  // Declared last so that queued asynchronous calls are drained while the other members are still alive.
+  std::shared_ptr<ThreadPool> thread_pool_;
 };
 
 }  // namespace huggingface_api_cpp::inference
@@ -0,0 +1,353 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cmath>
+#include <cstddef>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+namespace huggingface_api_cpp::inference {
+
+// A member of a struct, written as the field `name` of a JSON object. An empty `std::optional` member is left out.
+template <typename T, typename M>
+struct JsonField {
+  std::string_view name;
+  M T::*member;
+};
+
+template <typename T, typename M>
+JsonField(std::string_view, M T::*) -> JsonField<T, M>;
+
+// Describes how `AppendJsonValue()` writes a type, next to its `to_json()`:
+// - A struct has `kFields`, a tuple of `JsonField`s sorted by name. nlohmann::json keeps the keys of an object sorted,
+//   so the output matches `to_json()` byte for byte.
+// - An enum has a static `name(value)` returning the string to write.
+template <typename T>
+struct JsonSchema;
+
+template <typename T>
+concept HasJsonFields = requires { JsonSchema<T>::kFields; };
+
+// A field to write as well as the fields of a `JsonSchema`, or instead of the field with the same name.
+struct JsonExtraField {
+  std::string_view name;
+  const void* value;
+  void (*append)(std::string& json, const void* value);
+};
+
+namespace json_writer_internal {
+
+// Whether a byte ends the run of bytes that can be copied as they are: a quotation mark, a backslash, a control
+// character, or the first byte of a multi-byte UTF-8 sequence, which has to be validated.
+inline constexpr std::array<bool, 256> kIsSpecial = [] {
+  std::array<bool, 256> is_special{};
+  for (std::size_t byte = 0; byte < is_special.size(); ++byte) {
+    is_special[byte] = byte < 0x20 || byte == '"' || byte == '\\' || 0x80 <= byte;
+  }
+  return is_special;
+}();
+
+// The size of the well-formed UTF-8 sequence at the beginning of `bytes`, or 0 if it is not.
+inline std::size_t Utf8SequenceSize(std::string_view bytes) {
+  auto is_in = [bytes](std::size_t i, unsigned char min, unsigned char max) {
+    return i < bytes.size() && min <= static_cast<unsigned char>(bytes[i]) &&
+           static_cast<unsigned char>(bytes[i]) <= max;
+  };
+
+  const unsigned char lead = bytes[0];
+  if (0xC2 <= lead && lead <= 0xDF) {
+    return is_in(1, 0x80, 0xBF) ? 2 : 0;
+  }
+  if (0xE0 <= lead && lead <= 0xEF) {
+    // Rejects overlong sequences and surrogates.
+    const unsigned char min = lead == 0xE0 ? 0xA0 : 0x80;
+    const unsigned char max = lead == 0xED ? 0x9F : 0xBF;
+    return is_in(1, min, max) && is_in(2, 0x80, 0xBF) ? 3 : 0;
+  }
+  if (0xF0 <= lead && lead <= 0xF4) {
+    // Rejects overlong sequences and code points beyond U+10FFFF.
+    const unsigned char min = lead == 0xF0 ? 0x90 : 0x80;
+    const unsigned char max = lead == 0xF4 ? 0x8F : 0xBF;
+    return is_in(1, min, max) && is_in(2, 0x80, 0xBF) && is_in(3, 0x80, 0xBF) ? 4 : 0;
+  }
+  return 0;
+}
+
+template <typename T>
+struct IsOptional : std::false_type {};
+
+template <typename T>
+struct IsOptional<std::optional<T>> : std::true_type {};
+
+template <typename T>
+struct IsVector : std::false_type {};
+
+template <typename T>
+struct IsVector<std::vector<T>> : std::true_type {};
+
+template <typename T>
+struct IsStringMap : std::false_type {};
+
+template <typename T>
+struct IsStringMap<std::unordered_map<std::string, T>> : std::true_type {};
+
+template <typename T>
+constexpr bool IsSortedByName() {
+  return std::apply(
+      [](const auto&... fields) {
+        std::string_view previous_name;
+        bool is_sorted = true;
+        ((is_sorted = is_sorted && previous_name < fields.name, previous_name = fields.name), ...);
+        return is_sorted;
+      },
+      JsonSchema<T>::kFields);
+}
+
+}  // namespace json_writer_internal
+
+// Appends `value` as a JSON string, escaped as `nlohmann::json::dump()` does: the quotation mark, the backslash and
+// the control characters, and nothing else. If `value` is not valid UTF-8, leaves it to `dump()`, which throws.
+inline void AppendJsonString(std::string& json, std::string_view value) {
+  static constexpr char kHexDigits[] = "0123456789abcdef";
+
+  const std::size_t start = json.size();
+  json.push_back('"');
+  std::size_t begin = 0;  // Of the bytes not appended yet.
+  for (std::size_t i = 0; i < value.size();) {
+    const unsigned char byte = value[i];
+    if (!json_writer_internal::kIsSpecial[byte]) {
+      ++i;
+      continue;
+    }
+    if (0x80 <= byte) {
+      const std::size_t size = json_writer_internal::Utf8SequenceSize(value.substr(i));
+      if (size == 0) {
+        json.resize(start);
+        json += nlohmann::json(value).dump();
+        return;
+      }
+      i += size;
+      continue;
+    }
+
+    json.append(value.data() + begin, i - begin);
+    switch (byte) {
+      case '"':
+        json += "\\\"";
+        break;
+      case '\\':
+        json += "\\\\";
+        break;
+      case '\b':
+        json += "\\b";
+        break;
+      case '\t':
+        json += "\\t";
+        break;
+      case '\n':
+        json += "\\n";
+        break;
+      case '\f':
+        json += "\\f";
+        break;
+      case '\r':
+        json += "\\r";
+        break;
+      default:
+        json += "\\u00";
+        json.push_back(kHexDigits[byte >> 4]);
+        json.push_back(kHexDigits[byte & 0xF]);
+        break;
+    }
+    begin = ++i;
+  }
+  json.append(value.data() + begin, value.size() - begin);
+  json.push_back('"');
+}
+
+template <typename T>
+void AppendJsonObject(std::string& json, const T& object, std::span<const JsonExtraField> extra_fields = {});
+
+// Appends `value` as JSON, the same as `nlohmann::json(value).dump()` would, without building the tree.
+template <typename V>
+void AppendJsonValue(std::string& json, const V& value) {
+  if constexpr (std::is_same_v<V, bool>) {
+    json += value ? "true" : "false";
+  } else if constexpr (std::is_integral_v<V>) {
+    char buffer[24];
+    json.append(buffer, std::to_chars(buffer, buffer + sizeof(buffer), value).ptr);
+  } else if constexpr (std::is_floating_point_v<V>) {
+    // nlohmann::json stores a number as a double, prints it with the shortest round-trip digits, and prints the
+    // non-finite ones as null.
+    const double number = value;
+    if (!std::isfinite(number)) {
+      json += "null";
+      return;
+    }
+    char buffer[64];
+    json.append(buffer, nlohmann::detail::to_chars(buffer, buffer + sizeof(buffer), number));
+  } else if constexpr (std::is_enum_v<V>) {
+    AppendJsonString(json, JsonSchema<V>::name(value));
+  } else if constexpr (std::is_convertible_v<const V&, std::string_view>) {
+    AppendJsonString(json, value);
+  } else if constexpr (json_writer_internal::IsOptional<V>::value) {
+    if (value.has_value()) {
+      AppendJsonValue(json, value.value());
+    } else {
+      json += "null";
+    }
+  } else if constexpr (json_writer_internal::IsVector<V>::value) {
+    json.push_back('[');
+    for (std::size_t i = 0; i < value.size(); ++i) {
+      if (i != 0) {
+        json.push_back(',');
+      }
+      AppendJsonValue(json, value[i]);
+    }
+    json.push_back(']');
+  } else if constexpr (json_writer_internal::IsStringMap<V>::value) {
+    // nlohmann::json sorts the keys.
+    std::vector<const typename V::value_type*> entries;
+    entries.reserve(value.size());
+    for (const auto& entry : value) {
+      entries.push_back(&entry);
+    }
+    std::sort(entries.begin(), entries.end(), [](const auto* a, const auto* b) { return a->first < b->first; });
+
+    json.push_back('{');
+    for (std::size_t i = 0; i < entries.size(); ++i) {
+      if (i != 0) {
+        json.push_back(',');
+      }
+      AppendJsonString(json, entries[i]->first);
+      json.push_back(':');
+      AppendJsonValue(json, entries[i]->second);
+    }
+    json.push_back('}');
+  } else {
+    static_assert(HasJsonFields<V>, "AppendJsonValue() needs a JsonSchema for this type.");
+    AppendJsonObject(json, value);
+  }
+}
+
+// Appends the fields of `object` in its `JsonSchema`, merged with `extra_fields`, which must be sorted by name too.
+// Like `to_json()` with nlohmann::json, an object without any field is written as null.
+template <typename T>
+void AppendJsonObject(std::string& json, const T& object, std::span<const JsonExtraField> extra_fields) {
+  static_assert(json_writer_internal::IsSortedByName<T>(), "The fields of a JsonSchema must be sorted by name.");
+
+  const std::size_t start = json.size();
+  json.push_back('{');
+  bool is_empty = true;
+  auto append_name = [&json, &is_empty](std::string_view name) {
+    if (!is_empty) {
+      json.push_back(',');
+    }
+    is_empty = false;
+    // The names are identifiers, which need no escaping.
+    json.push_back('"');
+    json.append(name);
+    json += "\":";
+  };
+
+  // Appends the extra fields up to `name`, and returns whether one of them replaces the field `name`.
+  std::size_t extra_index = 0;
+  auto append_extra_fields = [&](std::string_view name) {
+    while (extra_index < extra_fields.size() && extra_fields[extra_index].name <= name) {
+      const JsonExtraField& extra_field = extra_fields[extra_index++];
+      append_name(extra_field.name);
+      extra_field.append(json, extra_field.value);
+      if (extra_field.name == name) {
+        return true;
+      }
+    }
+    return false;
+  };
+
+  std::apply(
+      [&](const auto&... fields) {
+        (
+            [&](const auto& field) {
+              if (append_extra_fields(field.name)) {
+                return;
+              }
+              const auto& value = object.*field.member;
+              if constexpr (json_writer_internal::IsOptional<std::decay_t<decltype(value)>>::value) {
+                if (!value.has_value()) {
+                  return;
+                }
+                append_name(field.name);
+                AppendJsonValue(json, value.value());
+              } else {
+                append_name(field.name);
+                AppendJsonValue(json, value);
+              }
+            }(fields),
+            ...);
+      },
+      JsonSchema<T>::kFields);
+  for (; extra_index < extra_fields.size(); ++extra_index) {
+    append_name(extra_fields[extra_index].name);
+    extra_fields[extra_index].append(json, extra_fields[extra_index].value);
+  }
+
+  if (is_empty) {
+    json.resize(start);
+    json += "null";
+    return;
+  }
+  json.push_back('}');
+}
+
+// `value` must outlive the returned field.
+template <typename V>
+JsonExtraField MakeJsonExtraField(std::string_view name, const V& value) {
+  return JsonExtraField{
+      .name = name,
+      .value = &value,
+      .append = [](std::string& json, const void* value) { AppendJsonValue(json, *static_cast<const V*>(value)); },
+  };
+}
+
+// About the size of `value` as JSON, to reserve the output buffer once. Assumes that the strings need no escaping.
+template <typename V>
+std::size_t EstimateJsonSize(const V& value) {
+  if constexpr (std::is_arithmetic_v<V> || std::is_enum_v<V>) {
+    return 24;
+  } else if constexpr (std::is_convertible_v<const V&, std::string_view>) {
+    return std::string_view(value).size() + 2;
+  } else if constexpr (json_writer_internal::IsOptional<V>::value) {
+    return value.has_value() ? EstimateJsonSize(value.value()) : 4;
+  } else if constexpr (json_writer_internal::IsVector<V>::value) {
+    std::size_t size = 2;
+    for (const auto& element : value) {
+      size += EstimateJsonSize(element) + 1;
+    }
+    return size;
+  } else if constexpr (json_writer_internal::IsStringMap<V>::value) {
+    std::size_t size = 2;
+    for (const auto& [key, element] : value) {
+      size += key.size() + EstimateJsonSize(element) + 4;
+    }
+    return size;
+  } else {
+    return std::apply(
+        [&value](const auto&... fields) {
+          return (std::size_t{2} + ... + (fields.name.size() + EstimateJsonSize(value.*fields.member) + 4));
+        },
+        JsonSchema<V>::kFields);
+  }
+}
+
+}  // namespace huggingface_api_cpp::inference
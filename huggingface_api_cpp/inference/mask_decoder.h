@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "huggingface_api_cpp/inference/base64.h"
+#include "huggingface_api_cpp/inference/results.h"
+
+namespace huggingface_api_cpp::inference {
+
+// Decodes the base64 mask of a segment into the PNG bytes, reusing the capacity of `png`. Returns false if the mask
+// is not valid base64, in which case `png` is left empty.
+inline bool DecodeMask(std::string_view mask, std::vector<char>& png,
+                       Base64Decoder decoder = BestBase64Decoder()) {
+  png.resize(Base64DecodedSize(mask));
+  const std::optional<std::size_t> size_opt = DecodeBase64(mask, png, decoder);
+  png.resize(size_opt.value_or(0));
+  return size_opt.has_value();
+}
+
+// A thread-safe pool of buffers for the decoded masks, so that decoding the masks of many segments does not allocate
+// once they have all been sized.
+class MaskBufferPool {
+ public:
+  // Owns a pooled buffer, and returns it to the pool on destruction.
+  class Handle {
+   public:
+    Handle(MaskBufferPool* pool, std::vector<char> png) : pool_(pool), png_(std::move(png)) {}
+
+    Handle(Handle&& other) : pool_(std::exchange(other.pool_, nullptr)), png_(std::move(other.png_)) {}
+    Handle& operator=(Handle&& other) = delete;
+
+    ~Handle() {
+      if (pool_ != nullptr) {
+        pool_->release(std::move(png_));
+      }
+    }
+
+    // The PNG bytes.
+    std::span<const char> png() const {
+      return png_;
+    }
+
+   private:
+    MaskBufferPool* pool_;
+    std::vector<char> png_;
+  };
+
+  MaskBufferPool(std::size_t max_idle_buffers = 64) : max_idle_buffers_(max_idle_buffers) {}
+
+  MaskBufferPool(const MaskBufferPool&) = delete;
+  MaskBufferPool& operator=(const MaskBufferPool&) = delete;
+
+  // Decodes `segment.mask` into a pooled buffer. Returns std::nullopt if the mask is not valid base64.
+  std::optional<Handle> decode(const ImageSegmentationResult& segment,
+                               Base64Decoder decoder = BestBase64Decoder()) {
+    std::vector<char> png;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (!idle_buffers_.empty()) {
+        png = std::move(idle_buffers_.back());
+        idle_buffers_.pop_back();
+      }
+    }
+
+    const bool is_decoded = DecodeMask(segment.mask, png, decoder);
+    Handle handle(this, std::move(png));
+    if (!is_decoded) {
+      return std::nullopt;
+    }
+    return handle;
+  }
+
+ private:
+  void release(std::vector<char> png) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (idle_buffers_.size() < max_idle_buffers_) {
+      idle_buffers_.push_back(std::move(png));
+    }
+  }
+
+  const std::size_t max_idle_buffers_;
+  std::mutex mutex_;
+  std::vector<std::vector<char>> idle_buffers_;
+};
+
+}  // namespace huggingface_api_cpp::inference
@@ -0,0 +1,460 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "huggingface_api_cpp/inference/transport.h"
+
+namespace huggingface_api_cpp::inference {
+
+// The counts of a `LatencyHistogram` at the time of the snapshot.
+struct LatencyHistogramSnapshot {
+  std::uint64_t count = 0;
+  std::chrono::microseconds sum = std::chrono::microseconds(0);
+  std::chrono::microseconds max = std::chrono::microseconds(0);
+  std::vector<std::uint64_t> bucket_counts;  // Indexed like `LatencyHistogram::kNumBuckets`, empty if `count == 0`.
+
+  // The upper bound of the bucket holding the `q` quantile, e.g. 0.99, which overestimates it by less than 25%.
+  std::chrono::microseconds quantile(double q) const;
+
+  // The number of values below `bound`, counting only the buckets entirely below it.
+  std::uint64_t countBelow(std::chrono::microseconds bound) const;
+};
+
+// A histogram of durations that many threads record into without locking. The buckets are log-linear: four per
+// power of two, so the error of a quantile is bounded relatively, from microseconds to days.
+class LatencyHistogram {
+ public:
+  static constexpr std::size_t kNumBuckets = 160;
+
+  LatencyHistogram() = default;
+
+  LatencyHistogram(const LatencyHistogram&) = delete;
+  LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+
+  void record(std::chrono::microseconds duration) {
+    const std::uint64_t value = static_cast<std::uint64_t>(std::max<std::int64_t>(duration.count(), 0));
+    bucket_counts_[BucketOf(value)].fetch_add(1, std::memory_order_relaxed);
+    sum_.fetch_add(value, std::memory_order_relaxed);
+    std::uint64_t max = max_.load(std::memory_order_relaxed);
+    while (max < value && !max_.compare_exchange_weak(max, value, std::memory_order_relaxed)) {
+    }
+  }
+
+  // Not atomic as a whole: a value recorded concurrently may be counted in some fields and not yet in others.
+  LatencyHistogramSnapshot snapshot() const {
+    LatencyHistogramSnapshot snapshot;
+    snapshot.bucket_counts.resize(kNumBuckets);
+    for (std::size_t i = 0; i < kNumBuckets; ++i) {
+      snapshot.bucket_counts[i] = bucket_counts_[i].load(std::memory_order_relaxed);
+      snapshot.count += snapshot.bucket_counts[i];
+    }
+    if (snapshot.count == 0) {
+      snapshot.bucket_counts.clear();
+    }
+    snapshot.sum = std::chrono::microseconds(sum_.load(std::memory_order_relaxed));
+    snapshot.max = std::chrono::microseconds(max_.load(std::memory_order_relaxed));
+    return snapshot;
+  }
+
+  // The values 0 to 3 have a bucket each. Above, the bucket of a value is given by its highest bit and the two bits
+  // below it. The last bucket also holds all the larger values.
+  static std::size_t BucketOf(std::uint64_t value) {
+    if (value < 4) {
+      return value;
+    }
+    const std::size_t exponent = std::bit_width(value) - 1;
+    const std::size_t bucket = (exponent - 1) * 4 + ((value >> (exponent - 2)) & 3);
+    return std::min(bucket, kNumBuckets - 1);
+  }
+
+  // The smallest value of the bucket `bucket`.
+  static std::uint64_t BucketLowerBound(std::size_t bucket) {
+    if (bucket < 4) {
+      return bucket;
+    }
+    return (4 + bucket % 4) << (bucket / 4 - 1);
+  }
+
+ private:
+  std::array<std::atomic<std::uint64_t>, kNumBuckets> bucket_counts_ = {};
+  std::atomic<std::uint64_t> sum_ = 0;
+  std::atomic<std::uint64_t> max_ = 0;
+};
+
+inline std::chrono::microseconds LatencyHistogramSnapshot::quantile(double q) const {
+  if (count == 0) {
+    return std::chrono::microseconds(0);
+  }
+  const std::uint64_t rank = std::max<std::uint64_t>(
+      static_cast<std::uint64_t>(std::clamp(q, 0.0, 1.0) * static_cast<double>(count) + 0.5), 1);
+  std::uint64_t cumulative_count = 0;
+  for (std::size_t i = 0; i < bucket_counts.size(); ++i) {
+    cumulative_count += bucket_counts[i];
+    if (rank <= cumulative_count) {
+      if (i + 1 == bucket_counts.size()) {
+        return max;
+      }
+      const std::uint64_t upper_bound = LatencyHistogram::BucketLowerBound(i + 1) - 1;
+      return std::min(std::chrono::microseconds(upper_bound), max);
+    }
+  }
+  return max;
+}
+
+inline std::uint64_t LatencyHistogramSnapshot::countBelow(std::chrono::microseconds bound) const {
+  std::uint64_t below = 0;
+  for (std::size_t i = 0; i + 1 < bucket_counts.size(); ++i) {
+    if (static_cast<std::int64_t>(LatencyHistogram::BucketLowerBound(i + 1)) > bound.count()) {
+      break;
+    }
+    below += bucket_counts[i];
+  }
+  return below;
+}
+
+// The metrics of the calls to one model for one task, since enabled.
+struct RequestMetricsSnapshot {
+  std::string model;
+  std::string task;  // E.g. "text-classification", see `kTaskName`.
+
+  std::uint64_t calls = 0;      // Completed calls that were sent, i.e. not served by a cache or a coalesced flight.
+  std::uint64_t transfers = 0;  // Attempts completed by the transport, including the retries.
+  std::uint64_t retries = 0;
+  std::uint64_t failed_transfers = 0;  // Without a response, e.g. a timeout or a refused connection.
+  std::uint64_t bytes_sent = 0;        // Of the request bodies.
+  std::uint64_t bytes_received = 0;    // Of the response bodies.
+  std::map<long, std::uint64_t> response_codes;  // Of the calls, by final response code. 0 means no response.
+
+  // The phase timings of the transfers, each measured from the start of the transfer as libcurl reports them: the
+  // name lookup, the TCP connect, the TLS handshake, the request about to be sent, the first response byte, and the
+  // whole transfer. On a reused connection, the first three are about zero.
+  LatencyHistogramSnapshot name_lookup;
+  LatencyHistogramSnapshot connect;
+  LatencyHistogramSnapshot app_connect;
+  LatencyHistogramSnapshot pretransfer;
+  LatencyHistogramSnapshot start_transfer;
+  LatencyHistogramSnapshot total;
+
+  // From the first attempt to the completion of the call, including the retries, their backoffs and the waits for
+  // the limiters.
+  LatencyHistogramSnapshot call_duration;
+};
+
+// Aggregates the transfers and the calls per model and task. Recording is lock-free once the series of a call has
+// been looked up, which takes a shared lock.
+class RequestMetrics {
+ public:
+  // The metrics of one model and task, which the calls record into.
+  class Series {
+   public:
+    static constexpr long kMaxResponseCode = 599;
+
+    Series(std::string model, std::string_view task) : model_(std::move(model)), task_(task) {}
+
+    Series(const Series&) = delete;
+    Series& operator=(const Series&) = delete;
+
+    void recordTransfer(const HttpResponse& http_response) {
+      transfers_.fetch_add(1, std::memory_order_relaxed);
+      if (http_response.exception_ptr && http_response.response_code == 0) {
+        failed_transfers_.fetch_add(1, std::memory_order_relaxed);
+      }
+      const TransferInfo& transfer_info = http_response.transfer_info;
+      bytes_sent_.fetch_add(transfer_info.bytes_sent, std::memory_order_relaxed);
+      bytes_received_.fetch_add(transfer_info.bytes_received, std::memory_order_relaxed);
+      name_lookup_.record(transfer_info.name_lookup_time);
+      connect_.record(transfer_info.connect_time);
+      app_connect_.record(transfer_info.app_connect_time);
+      pretransfer_.record(transfer_info.pretransfer_time);
+      start_transfer_.record(transfer_info.start_transfer_time);
+      total_.record(transfer_info.total_time);
+    }
+
+    // `response_code` is 0 if the last attempt got no response.
+    void recordCall(long response_code, std::size_t num_attempts, std::chrono::steady_clock::duration duration) {
+      calls_.fetch_add(1, std::memory_order_relaxed);
+      retries_.fetch_add(num_attempts == 0 ? 0 : num_attempts - 1, std::memory_order_relaxed);
+      const std::size_t index = (response_code < 0 || kMaxResponseCode < response_code) ? 0 : response_code;
+      response_codes_[index].fetch_add(1, std::memory_order_relaxed);
+      call_duration_.record(std::chrono::duration_cast<std::chrono::microseconds>(duration));
+    }
+
+    RequestMetricsSnapshot snapshot() const {
+      RequestMetricsSnapshot snapshot;
+      snapshot.model = model_;
+      snapshot.task = std::string(task_);
+      snapshot.calls = calls_.load(std::memory_order_relaxed);
+      snapshot.transfers = transfers_.load(std::memory_order_relaxed);
+      snapshot.retries = retries_.load(std::memory_order_relaxed);
+      snapshot.failed_transfers = failed_transfers_.load(std::memory_order_relaxed);
+      snapshot.bytes_sent = bytes_sent_.load(std::memory_order_relaxed);
+      snapshot.bytes_received = bytes_received_.load(std::memory_order_relaxed);
+      for (std::size_t code = 0; code < response_codes_.size(); ++code) {
+        if (const std::uint64_t count = response_codes_[code].load(std::memory_order_relaxed); count != 0) {
+          snapshot.response_codes[static_cast<long>(code)] = count;
+        }
+      }
+      snapshot.name_lookup = name_lookup_.snapshot();
+      snapshot.connect = connect_.snapshot();
+      snapshot.app_connect = app_connect_.snapshot();
+      snapshot.pretransfer = pretransfer_.snapshot();
+      snapshot.start_transfer = start_transfer_.snapshot();
+      snapshot.total = total_.snapshot();
+      snapshot.call_duration = call_duration_.snapshot();
+      return snapshot;
+    }
+
+    const std::string& model() const {
+      return model_;
+    }
+
+    std::string_view task() const {
+      return task_;
+    }
+
+   private:
+    const std::string model_;
+    const std::string_view task_;  // A `kTaskName`, which is static.
+
+    std::atomic<std::uint64_t> calls_ = 0;
+    std::atomic<std::uint64_t> transfers_ = 0;
+    std::atomic<std::uint64_t> retries_ = 0;
+    std::atomic<std::uint64_t> failed_transfers_ = 0;
+    std::atomic<std::uint64_t> bytes_sent_ = 0;
+    std::atomic<std::uint64_t> bytes_received_ = 0;
+    std::array<std::atomic<std::uint64_t>, kMaxResponseCode + 1> response_codes_ = {};
+    LatencyHistogram name_lookup_;
+    LatencyHistogram connect_;
+    LatencyHistogram app_connect_;
+    LatencyHistogram pretransfer_;
+    LatencyHistogram start_transfer_;
+    LatencyHistogram total_;
+    LatencyHistogram call_duration_;
+  };
+
+  RequestMetrics() = default;
+
+  RequestMetrics(const RequestMetrics&) = delete;
+  RequestMetrics& operator=(const RequestMetrics&) = delete;
+
+  // Returns the series of `model` and `task`, created on first use. `task` must be static, e.g. a `kTaskName`.
+  std::shared_ptr<Series> series(std::string_view model, std::string_view task) {
+    {
+      std::shared_lock<std::shared_mutex> lock(mutex_);
+      if (std::shared_ptr<Series> series = findSeries(model, task)) {
+        return series;
+      }
+    }
+
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    if (std::shared_ptr<Series> series = findSeries(model, task)) {
+      return series;
+    }
+    auto it = series_by_model_.find(model);
+    if (it == series_by_model_.end()) {
+      it = series_by_model_.emplace(std::string(model), std::vector<std::shared_ptr<Series>>()).first;
+    }
+    it->second.push_back(std::make_shared<Series>(std::string(model), task));
+    return it->second.back();
+  }
+
+  // Sorted by model, then by task.
+  std::vector<RequestMetricsSnapshot> snapshot() const {
+    std::vector<std::shared_ptr<Series>> all_series;
+    {
+      std::shared_lock<std::shared_mutex> lock(mutex_);
+      for (const auto& [model, model_series] : series_by_model_) {
+        all_series.insert(all_series.end(), model_series.begin(), model_series.end());
+      }
+    }
+
+    std::vector<RequestMetricsSnapshot> snapshots;
+    snapshots.reserve(all_series.size());
+    for (const std::shared_ptr<Series>& series : all_series) {
+      snapshots.push_back(series->snapshot());
+    }
+    std::sort(snapshots.begin(), snapshots.end(), [](const auto& a, const auto& b) {
+      return std::tie(a.model, a.task) < std::tie(b.model, b.task);
+    });
+    return snapshots;
+  }
+
+ private:
+  // Looks the models up by `std::string_view`, without copying them out of the calls.
+  struct ModelHash {
+    using is_transparent = void;
+
+    std::size_t operator()(std::string_view model) const {
+      return std::hash<std::string_view>()(model);
+    }
+  };
+
+  std::shared_ptr<Series> findSeries(std::string_view model, std::string_view task) const {
+    auto it = series_by_model_.find(model);
+    if (it == series_by_model_.end()) {
+      return nullptr;
+    }
+    // A model is called for few tasks, usually one.
+    for (const std::shared_ptr<Series>& series : it->second) {
+      if (series->task() == task) {
+        return series;
+      }
+    }
+    return nullptr;
+  }
+
+  mutable std::shared_mutex mutex_;
+  std::unordered_map<std::string, std::vector<std::shared_ptr<Series>>, ModelHash, std::equal_to<>> series_by_model_;
+};
+
+namespace metrics_internal {
+
+// Escapes a label value of the Prometheus text format.
+inline std::string PrometheusLabelValue(std::string_view value) {
+  std::string escaped;
+  escaped.reserve(value.size());
+  for (const char c : value) {
+    if (c == '\\') {
+      escaped += "\\\\";
+    } else if (c == '"') {
+      escaped += "\\\"";
+    } else if (c == '\n') {
+      escaped += "\\n";
+    } else {
+      escaped.push_back(c);
+    }
+  }
+  return escaped;
+}
+
+inline std::string PrometheusSeconds(std::chrono::microseconds duration) {
+  const std::string seconds = std::to_string(static_cast<double>(duration.count()) / 1e6);
+  // std::to_string() prints 6 decimals, i.e. the microseconds, of which the trailing zeros are dropped.
+  const std::size_t end = seconds.find_last_not_of('0');
+  return seconds.substr(0, seconds[end] == '.' ? end : end + 1);
+}
+
+}  // namespace metrics_internal
+
+// Formats `snapshots` in the Prometheus text exposition format, e.g. to serve them on a /metrics endpoint. The
+// histograms are exported with fixed bucket bounds from 500 us to 60 s, each counting the values of the buckets of
+// `LatencyHistogram` entirely below it.
+inline std::string FormatPrometheusMetrics(const std::vector<RequestMetricsSnapshot>& snapshots,
+                                           std::string_view prefix = "hf_inference") {
+  using metrics_internal::PrometheusLabelValue;
+  using metrics_internal::PrometheusSeconds;
+
+  static constexpr std::array<std::chrono::microseconds, 15> kBucketBounds = {
+      std::chrono::microseconds(500),    std::chrono::microseconds(1000),    std::chrono::microseconds(2500),
+      std::chrono::microseconds(5000),   std::chrono::microseconds(10000),   std::chrono::microseconds(25000),
+      std::chrono::microseconds(50000),  std::chrono::microseconds(100000),  std::chrono::microseconds(250000),
+      std::chrono::microseconds(500000), std::chrono::microseconds(1000000), std::chrono::microseconds(2500000),
+      std::chrono::microseconds(5000000), std::chrono::microseconds(10000000), std::chrono::microseconds(60000000),
+  };
+
+  std::vector<std::string> labels;
+  labels.reserve(snapshots.size());
+  for (const RequestMetricsSnapshot& snapshot : snapshots) {
+    labels.push_back("model=\"" + PrometheusLabelValue(snapshot.model) + "\",task=\"" +
+                     PrometheusLabelValue(snapshot.task) + "\"");
+  }
+
+  std::string text;
+  auto append_header = [&text, prefix](std::string_view name, std::string_view type, std::string_view help) {
+    text += "# HELP ";
+    text += prefix;
+    text += name;
+    text += ' ';
+    text += help;
+    text += "\n# TYPE ";
+    text += prefix;
+    text += name;
+    text += ' ';
+    text += type;
+    text += '\n';
+  };
+  auto append_sample = [&text, prefix](std::string_view name, const std::string& labels, std::string_view value) {
+    text += prefix;
+    text += name;
+    text += '{';
+    text += labels;
+    text += "} ";
+    text += value;
+    text += '\n';
+  };
+  auto append_counter = [&](std::string_view name, std::string_view help,
+                            std::uint64_t RequestMetricsSnapshot::*member) {
+    append_header(name, "counter", help);
+    for (std::size_t i = 0; i < snapshots.size(); ++i) {
+      append_sample(name, labels[i], std::to_string(snapshots[i].*member));
+    }
+  };
+  auto append_histogram = [&](const LatencyHistogramSnapshot& histogram, std::string_view name,
+                              const std::string& labels) {
+    for (const std::chrono::microseconds bound : kBucketBounds) {
+      append_sample(std::string(name) + "_bucket", labels + ",le=\"" + PrometheusSeconds(bound) + "\"",
+                    std::to_string(histogram.countBelow(bound)));
+    }
+    append_sample(std::string(name) + "_bucket", labels + ",le=\"+Inf\"", std::to_string(histogram.count));
+    append_sample(std::string(name) + "_sum", labels, PrometheusSeconds(histogram.sum));
+    append_sample(std::string(name) + "_count", labels, std::to_string(histogram.count));
+  };
+
+  append_counter("_calls_total", "Completed calls that were sent.", &RequestMetricsSnapshot::calls);
+  append_counter("_transfers_total", "Transfers, including the retries.", &RequestMetricsSnapshot::transfers);
+  append_counter("_retries_total", "Retried attempts.", &RequestMetricsSnapshot::retries);
+  append_counter("_failed_transfers_total", "Transfers that got no response.",
+                 &RequestMetricsSnapshot::failed_transfers);
+  append_counter("_sent_bytes_total", "Bytes of the request bodies.", &RequestMetricsSnapshot::bytes_sent);
+  append_counter("_received_bytes_total", "Bytes of the response bodies.", &RequestMetricsSnapshot::bytes_received);
+
+  append_header("_responses_total", "counter", "Completed calls by final response code, 0 if none.");
+  for (std::size_t i = 0; i < snapshots.size(); ++i) {
+    for (const auto& [code, count] : snapshots[i].response_codes) {
+      append_sample("_responses_total", labels[i] + ",code=\"" + std::to_string(code) + "\"", std::to_string(count));
+    }
+  }
+
+  append_header("_transfer_phase_seconds", "histogram",
+                "Time from the start of a transfer to the end of each phase, as reported by libcurl.");
+  static constexpr std::pair<std::string_view, LatencyHistogramSnapshot RequestMetricsSnapshot::*> kPhases[] = {
+      {"name_lookup", &RequestMetricsSnapshot::name_lookup},
+      {"connect", &RequestMetricsSnapshot::connect},
+      {"app_connect", &RequestMetricsSnapshot::app_connect},
+      {"pretransfer", &RequestMetricsSnapshot::pretransfer},
+      {"start_transfer", &RequestMetricsSnapshot::start_transfer},
+      {"total", &RequestMetricsSnapshot::total},
+  };
+  for (std::size_t i = 0; i < snapshots.size(); ++i) {
+    for (const auto& [phase, member] : kPhases) {
+      append_histogram(snapshots[i].*member, "_transfer_phase_seconds",
+                       labels[i] + ",phase=\"" + std::string(phase) + "\"");
+    }
+  }
+
+  append_header("_call_duration_seconds", "histogram",
+                "Time from the first attempt of a call to its completion, including the retries.");
+  for (std::size_t i = 0; i < snapshots.size(); ++i) {
+    append_histogram(snapshots[i].call_duration, "_call_duration_seconds", labels[i]);
+  }
+  return text;
+}
+
+}  // namespace huggingface_api_cpp::inference
@@ -0,0 +1,268 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <curl/curl.h>
+#include <curlpp/cURLpp.hpp>
+#include <curlpp/Easy.hpp>
+
+#include "huggingface_api_cpp/inference/transport.h"
+
+namespace huggingface_api_cpp::inference {
+
+// Drives many concurrent requests from a few I/O threads with the libcurl multi interface.
+// Each I/O thread runs one event loop that owns a `CURLM` handle, so its connections (including HTTP/2
+// multiplexed streams) are shared by all the transfers of that loop.
+// Completions are invoked on the I/O threads, so they must be short and must not block. A cancelled transfer is
+// aborted on the next wake-up of its event loop.
+// The transfers, the easy handles and the bookkeeping of each event loop are recycled, so that a steady stream of
+// requests does not allocate in the transport.
+class MultiTransport : public Transport {
+ public:
+  // `max_host_connections == 0` means unlimited.
+  MultiTransport(std::size_t num_io_threads = 1, long max_host_connections = 0) {
+    for (std::size_t i = 0; i < std::max<std::size_t>(num_io_threads, 1); ++i) {
+      event_loops_.push_back(std::make_shared<EventLoop>(max_host_connections));
+      event_loops_.back()->start();
+    }
+  }
+
+  MultiTransport(const MultiTransport&) = delete;
+  MultiTransport& operator=(const MultiTransport&) = delete;
+
+  // Aborts the transfers still in flight and completes them with an error. May run on an I/O thread, when a
+  // completion releases the last reference to the transport.
+  ~MultiTransport() {
+    for (const auto& event_loop : event_loops_) {
+      event_loop->stop();
+    }
+  }
+
+  void perform(HttpRequest http_request, Completion completion) override {
+    const std::size_t index = next_event_loop_.fetch_add(1, std::memory_order_relaxed) % event_loops_.size();
+    event_loops_[index]->submit(std::move(http_request), std::move(completion));
+  }
+
+  bool isBlocking() const override {
+    return false;
+  }
+
+  std::size_t numInFlight() const {
+    std::size_t num_in_flight = 0;
+    for (const auto& event_loop : event_loops_) {
+      num_in_flight += event_loop->numInFlight();
+    }
+    return num_in_flight;
+  }
+
+ private:
+  // Kept alive by its I/O thread as well, so that it can be stopped from that thread.
+  class EventLoop : public std::enable_shared_from_this<EventLoop> {
+   public:
+    EventLoop(long max_host_connections) : multi_handle_(curl_multi_init()) {
+      curl_multi_setopt(multi_handle_, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+      curl_multi_setopt(multi_handle_, CURLMOPT_MAX_HOST_CONNECTIONS, max_host_connections);
+    }
+
+    ~EventLoop() {
+      curl_multi_cleanup(multi_handle_);
+    }
+
+    void start() {
+      thread_ = std::thread([self = shared_from_this()]() { self->run(); });
+    }
+
+    // Waits for the I/O thread to finish, unless called on it.
+    void stop() {
+      stopping_ = true;
+      curl_multi_wakeup(multi_handle_);
+      if (thread_.get_id() == std::this_thread::get_id()) {
+        thread_.detach();
+      } else {
+        thread_.join();
+      }
+    }
+
+    void submit(HttpRequest http_request, Transport::Completion completion) {
+      std::unique_ptr<Transfer> transfer;
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!free_transfers_.empty()) {
+          transfer = std::move(free_transfers_.back());
+          free_transfers_.pop_back();
+        }
+      }
+      if (!transfer) {
+        transfer = std::make_unique<Transfer>();
+      }
+      transfer->http_request = std::move(http_request);
+      transfer->completion = std::move(completion);
+
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        pending_.push_back(std::move(transfer));
+      }
+      num_in_flight_.fetch_add(1, std::memory_order_relaxed);
+      curl_multi_wakeup(multi_handle_);
+    }
+
+    std::size_t numInFlight() const {
+      return num_in_flight_.load(std::memory_order_relaxed);
+    }
+
+   private:
+    void run() {
+      int num_running = 0;
+      while (!stopping_) {
+        abortCancelled();
+        addPending();
+
+        curl_multi_perform(multi_handle_, &num_running);
+
+        int num_messages = 0;
+        while (CURLMsg* message = curl_multi_info_read(multi_handle_, &num_messages)) {
+          if (message->msg == CURLMSG_DONE) {
+            complete(message->easy_handle, message->data.result);
+          }
+        }
+
+        curl_multi_poll(multi_handle_, nullptr, 0, 1000, nullptr);
+      }
+
+      abortAll();
+    }
+
+    void abortAll() {
+      for (auto& [curl_handle, active] : active_) {
+        auto& [easy, transfer] = active;
+        curl_multi_remove_handle(multi_handle_, curl_handle);
+        transfer->finish(*easy, CURLE_ABORTED_BY_CALLBACK, "MultiTransport is shutting down.");
+        transfer->complete();
+      }
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        submitted_.swap(pending_);
+      }
+      for (auto& transfer : submitted_) {
+        transfer->http_response.exception_ptr = std::make_exception_ptr(
+            curlpp::LibcurlRuntimeError("MultiTransport is shutting down.", CURLE_ABORTED_BY_CALLBACK));
+        transfer->complete();
+      }
+      submitted_.clear();
+      active_.clear();
+      idle_handles_.clear();
+    }
+
+    // Swaps the queue with `submitted_`, so that both keep their capacity.
+    void addPending() {
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        submitted_.swap(pending_);
+      }
+
+      for (std::unique_ptr<Transfer>& transfer : submitted_) {
+        std::unique_ptr<curlpp::Easy> easy;
+        if (idle_handles_.empty()) {
+          easy = std::make_unique<curlpp::Easy>();
+        } else {
+          easy = std::move(idle_handles_.back());
+          idle_handles_.pop_back();
+          easy->reset();
+        }
+
+        CURL* curl_handle = easy->getHandle();
+        transfer->setUp(*easy);
+        curl_easy_setopt(curl_handle, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_2TLS);
+        curl_multi_add_handle(multi_handle_, curl_handle);
+        if (transfer->http_request.cancellation) {
+          // If cancelled already, the transfer is aborted by its progress callback instead.
+          transfer->http_request.cancellation->setOnCancel([this, curl_handle]() {
+            {
+              std::lock_guard<std::mutex> lock(mutex_);
+              cancelled_.push_back(curl_handle);
+            }
+            curl_multi_wakeup(multi_handle_);
+          });
+        }
+        if (free_nodes_.empty()) {
+          active_.emplace(curl_handle, std::make_pair(std::move(easy), std::move(transfer)));
+        } else {
+          ActiveMap::node_type node = std::move(free_nodes_.back());
+          free_nodes_.pop_back();
+          node.key() = curl_handle;
+          node.mapped() = std::make_pair(std::move(easy), std::move(transfer));
+          active_.insert(std::move(node));
+        }
+      }
+      submitted_.clear();
+    }
+
+    // A handle is queued by the cancellation of a transfer still in flight, which is completed on this thread only
+    // after the queue has been drained, so the handle cannot have been reused by another transfer yet.
+    void abortCancelled() {
+      std::vector<CURL*> cancelled;
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        cancelled.swap(cancelled_);
+      }
+
+      for (CURL* curl_handle : cancelled) {
+        if (active_.contains(curl_handle)) {
+          complete(curl_handle, CURLE_ABORTED_BY_CALLBACK);
+        }
+      }
+    }
+
+    void complete(CURL* curl_handle, CURLcode curl_code) {
+      curl_multi_remove_handle(multi_handle_, curl_handle);
+
+      ActiveMap::node_type node = active_.extract(curl_handle);
+      std::unique_ptr<curlpp::Easy> easy = std::move(node.mapped().first);
+      std::unique_ptr<Transfer> transfer = std::move(node.mapped().second);
+      free_nodes_.push_back(std::move(node));
+
+      transfer->finish(*easy, curl_code, nullptr);
+      idle_handles_.push_back(std::move(easy));
+
+      num_in_flight_.fetch_sub(1, std::memory_order_relaxed);
+      transfer->complete();
+
+      // Drops the request, e.g. its body, before the transfer waits for reuse.
+      *transfer = Transfer();
+      std::lock_guard<std::mutex> lock(mutex_);
+      free_transfers_.push_back(std::move(transfer));
+    }
+
+    using ActiveMap = std::unordered_map<CURL*, std::pair<std::unique_ptr<curlpp::Easy>, std::unique_ptr<Transfer>>>;
+
+    curlpp::Cleanup curlpp_cleanup_;  // Keeps libcurl initialized while the multi handle is alive.
+    CURLM* multi_handle_;
+    std::thread thread_;
+    std::atomic<bool> stopping_ = false;
+    std::atomic<std::size_t> num_in_flight_ = 0;
+
+    std::mutex mutex_;
+    std::vector<std::unique_ptr<Transfer>> pending_;
+    std::vector<CURL*> cancelled_;
+    std::vector<std::unique_ptr<Transfer>> free_transfers_;
+
+    // Only accessed by the I/O thread.
+    std::vector<std::unique_ptr<Transfer>> submitted_;
+    ActiveMap active_;
+    std::vector<ActiveMap::node_type> free_nodes_;  // Of `active_`, emptied, to insert without allocating.
+    std::vector<std::unique_ptr<curlpp::Easy>> idle_handles_;
+  };
+
+  std::vector<std::shared_ptr<EventLoop>> event_loops_;
+  std::atomic<std::size_t> next_event_loop_ = 0;
+};
+
+}  // namespace huggingface_api_cpp::inference
@@ -1,7 +1,15 @@
 #pragma once
 
+#include <cstddef>
+
 #include <nlohmann/json.hpp>
 
+#include "huggingface_api_cpp/inference/compression.h"
+#include "huggingface_api_cpp/inference/hedge_policy.h"
+#include "huggingface_api_cpp/inference/json_writer.h"
+#include "huggingface_api_cpp/inference/retry_policy.h"
+#include "huggingface_api_cpp/inference/scheduler.h"
+
 namespace huggingface_api_cpp::inference {
 
 struct Options {
@@ -9,12 +17,28 @@ struct Options {
   bool use_cache = true;
   bool use_gpu = false;
   bool wait_for_model = false;
+  RetryPolicy retry_policy = {};              // Applies if `retry_on_error` is set.
+  HedgePolicy hedge_policy = {};              // Disabled by default.
+  CompressionPolicy compression_policy = {};  // Accepts encoded responses, sends requests as is.
+  SchedulingPolicy scheduling_policy = {};    // Normal priority, no deadline.
+};
+
+// Limits of each request sent by the `*Batch()` methods. An input larger than `max_batch_bytes` is sent alone.
+struct BatchOptions {
+  std::size_t max_batch_size = 32;         // Maximum number of inputs per request.
+  std::size_t max_batch_bytes = 64 * 1024;  // Maximum total size of the inputs per request.
+};
+
+// Limits of the result streams returned by the `*Stream()` methods.
+struct StreamOptions {
+  std::size_t max_buffered_results = 64;  // Results received but not consumed yet, beyond which the transfer waits.
 };
 
 struct ExtendedOptions : public Options {
   ExtendedOptions(const Options& options) : Options(options) {}
   bool binary = false;  // Whether the input is a file or not.
   bool blob = false;    // Whether the output_string_ftr is a file or not.
+  bool stream = false;  // Whether the output is a stream of server-sent events or not.
 };
 
 void to_json(nlohmann::json& json, const ExtendedOptions& extended_options) {
@@ -28,4 +52,16 @@ void to_json(nlohmann::json& json, const ExtendedOptions& extended_options) {
   };
 }
 
+template <>
+struct JsonSchema<ExtendedOptions> {
+  static constexpr std::tuple kFields = {
+    JsonField{"binary", &ExtendedOptions::binary},
+    JsonField{"blob", &ExtendedOptions::blob},
+    JsonField{"retry_on_error", &ExtendedOptions::retry_on_error},
+    JsonField{"use_cache", &ExtendedOptions::use_cache},
+    JsonField{"use_gpu", &ExtendedOptions::use_gpu},
+    JsonField{"wait_for_model", &ExtendedOptions::wait_for_model},
+  };
+};
+
 }  // namespace huggingface_api_cpp::inference
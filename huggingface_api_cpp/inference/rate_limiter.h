@@ -0,0 +1,153 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+namespace huggingface_api_cpp::inference {
+
+// Zero rates mean unlimited.
+struct RateLimiterConfig {
+  double requests_per_second = 0.0;  // For all the models together.
+  double burst = 20.0;               // Requests sent without waiting after an idle period.
+  double requests_per_second_per_model = 0.0;
+  double burst_per_model = 5.0;
+
+  // On a 429 response, the rate of the model is multiplied by `throttle_factor`, and the model is paused for the
+  // Retry-After delay of the response, or `throttle_pause` without one. Each successful response then restores
+  // `recovery_ratio` of the configured rate, up to that rate.
+  double throttle_factor = 0.5;
+  std::chrono::milliseconds throttle_pause = std::chrono::seconds(1);
+  double recovery_ratio = 0.02;
+  double min_requests_per_second_per_model = 0.1;
+};
+
+struct RateLimiterStats {
+  std::uint64_t delayed_requests = 0;     // Requests that waited for the rate limits before being sent.
+  std::uint64_t throttled_responses = 0;  // 429 responses received.
+};
+
+// Token buckets limiting the requests sent per model and in total, so that callers wait on the client instead of
+// sending requests that the server would reject. A request reserves its slot when it is about to be sent, and waits
+// for it: the reservations of the waiting requests make up the queue, in order.
+class RateLimiter {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  RateLimiter(const RateLimiterConfig& config = RateLimiterConfig()) : config_(config) {
+    global_bucket_.setRate(config_.requests_per_second, config_.burst);
+  }
+
+  RateLimiter(const RateLimiter&) = delete;
+  RateLimiter& operator=(const RateLimiter&) = delete;
+
+  // Reserves the next slot of `model`, and returns how long to wait before sending the request.
+  Clock::duration reserve(const std::string& model) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const Clock::time_point now = Clock::now();
+    Bucket& model_bucket = modelBucket(model);
+    const Clock::time_point send_time = std::max(global_bucket_.earliest(now), model_bucket.earliest(now));
+    global_bucket_.take(send_time);
+    model_bucket.take(send_time);
+    if (now < send_time) {
+      ++stats_.delayed_requests;
+    }
+    return send_time - now;
+  }
+
+  // Slows `model` down after a 429 response.
+  void onThrottled(const std::string& model, std::optional<std::chrono::milliseconds> retry_after_opt) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++stats_.throttled_responses;
+    Bucket& model_bucket = modelBucket(model);
+    model_bucket.paused_until = std::max(model_bucket.paused_until,
+                                         Clock::now() + retry_after_opt.value_or(config_.throttle_pause));
+    if (0.0 < model_bucket.rate) {
+      model_bucket.setRate(std::max(model_bucket.rate * config_.throttle_factor,
+                                    config_.min_requests_per_second_per_model),
+                           config_.burst_per_model);
+    }
+  }
+
+  // Speeds `model` back up towards its configured rate.
+  void onSuccess(const std::string& model) {
+    if (config_.requests_per_second_per_model <= 0.0) {
+      return;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    Bucket& model_bucket = modelBucket(model);
+    if (model_bucket.rate < config_.requests_per_second_per_model) {
+      model_bucket.setRate(std::min(model_bucket.rate + config_.requests_per_second_per_model * config_.recovery_ratio,
+                                    config_.requests_per_second_per_model),
+                           config_.burst_per_model);
+    }
+  }
+
+  // The current rate of `model`, lowered by the 429 responses. Zero means unlimited.
+  double modelRate(const std::string& model) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = model_buckets_.find(model);
+    return it != model_buckets_.end() ? it->second.rate : config_.requests_per_second_per_model;
+  }
+
+  RateLimiterStats stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+  }
+
+ private:
+  // A token bucket in its "virtual scheduling" form: `theoretical_arrival_time` advances by one interval per request,
+  // and a request may be sent once it is no more than `burst` intervals ahead of it.
+  struct Bucket {
+    double rate = 0.0;
+    Clock::duration interval = Clock::duration::zero();
+    Clock::duration tolerance = Clock::duration::zero();
+    Clock::time_point theoretical_arrival_time = Clock::time_point::min();
+    Clock::time_point paused_until = Clock::time_point::min();
+
+    void setRate(double requests_per_second, double burst) {
+      rate = requests_per_second;
+      if (rate <= 0.0) {
+        interval = tolerance = Clock::duration::zero();
+        return;
+      }
+      interval = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / rate));
+      tolerance = std::chrono::duration_cast<Clock::duration>(interval * std::max(burst - 1.0, 0.0));
+    }
+
+    Clock::time_point earliest(Clock::time_point now) const {
+      Clock::time_point time = std::max(now, paused_until);
+      if (0.0 < rate && theoretical_arrival_time != Clock::time_point::min()) {
+        time = std::max(time, theoretical_arrival_time - tolerance);
+      }
+      return time;
+    }
+
+    void take(Clock::time_point send_time) {
+      if (0.0 < rate) {
+        theoretical_arrival_time = std::max(theoretical_arrival_time, send_time) + interval;
+      }
+    }
+  };
+
+  Bucket& modelBucket(const std::string& model) {
+    auto [it, is_new] = model_buckets_.try_emplace(model);
+    if (is_new) {
+      it->second.setRate(config_.requests_per_second_per_model, config_.burst_per_model);
+    }
+    return it->second;
+  }
+
+  const RateLimiterConfig config_;
+
+  mutable std::mutex mutex_;
+  Bucket global_bucket_;
+  std::unordered_map<std::string, Bucket> model_buckets_;
+  RateLimiterStats stats_;
+};
+
+}  // namespace huggingface_api_cpp::inference
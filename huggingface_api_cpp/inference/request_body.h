@@ -0,0 +1,92 @@
+#pragma once
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstddef>
+#include <filesystem>
+#include <ios>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+
+namespace huggingface_api_cpp::inference {
+
+// An immutable request body that libcurl reads in place. Depending on how it was made, it owns a string, maps a
+// file into memory, or refers to a caller-owned buffer. Copies share the same bytes.
+class RequestBody {
+ public:
+  RequestBody() = default;
+
+  static RequestBody FromString(std::string body) {
+    auto owner = std::make_shared<const std::string>(std::move(body));
+    return RequestBody(owner, owner->data(), owner->size());
+  }
+
+  // Maps the file read-only, so the pages are shared with the page cache instead of being copied to the heap.
+  // Throws `std::ios_base::failure` if the file cannot be opened or mapped.
+  static RequestBody FromFile(const std::filesystem::path& file_path) {
+    const int fd = ::open(file_path.c_str(), O_RDONLY);
+    if (fd < 0) {
+      throw std::ios_base::failure("Cannot open " + file_path.string());
+    }
+
+    struct stat file_stat;
+    if (::fstat(fd, &file_stat) != 0) {
+      ::close(fd);
+      throw std::ios_base::failure("Cannot stat " + file_path.string());
+    }
+    const std::size_t size = file_stat.st_size;
+    if (size == 0) {
+      ::close(fd);
+      return RequestBody();
+    }
+
+    void* mapped = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);  // The mapping stays valid after closing the file descriptor.
+    if (mapped == MAP_FAILED) {
+      throw std::ios_base::failure("Cannot map " + file_path.string());
+    }
+    ::madvise(mapped, size, MADV_SEQUENTIAL);
+
+    std::shared_ptr<const void> owner(mapped, [size](const void* mapped) {
+      ::munmap(const_cast<void*>(mapped), size);
+    });
+    return RequestBody(owner, static_cast<const char*>(mapped), size);
+  }
+
+  // Does not copy `buffer`, which must stay alive until the request has completed.
+  static RequestBody FromBuffer(std::span<const char> buffer) {
+    return buffer.empty() ? RequestBody() : RequestBody(nullptr, buffer.data(), buffer.size());
+  }
+
+  const char* data() const {
+    return data_;
+  }
+
+  std::size_t size() const {
+    return size_;
+  }
+
+  std::string_view view() const {
+    return std::string_view(data_, size_);
+  }
+
+  // Whether the body keeps its data alive by itself, i.e. it was not made by `FromBuffer()`.
+  bool ownsData() const {
+    return owner_ != nullptr || size_ == 0;
+  }
+
+ private:
+  RequestBody(std::shared_ptr<const void> owner, const char* data, std::size_t size)
+      : owner_(std::move(owner)), data_(data), size_(size) {}
+
+  std::shared_ptr<const void> owner_;
+  const char* data_ = "";  // Never null, since libcurl would read a null body from a read callback.
+  std::size_t size_ = 0;
+};
+
+}  // namespace huggingface_api_cpp::inference
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <span>
+#include <string>
+#include <type_traits>
+
+#include <nlohmann/json.hpp>
+
+#include "huggingface_api_cpp/inference/args.h"
+#include "huggingface_api_cpp/inference/json_writer.h"
+#include "huggingface_api_cpp/inference/options.h"
+
+namespace huggingface_api_cpp::inference {
+
+// Serializes the arguments of a task and its options into the JSON body of the request, through a nlohmann::json
+// tree. Used for the arguments without a `JsonSchema`, and as the reference output of `AppendBodyFromJson()`.
+template <typename T>
+std::string MakeBodyFromJsonTree(const T& other_args, const ExtendedOptions& extended_options) {
+  // Composes a JSON object.
+  nlohmann::json body_json = other_args;
+  body_json["options"] = extended_options;
+  if (extended_options.stream) {
+    body_json["stream"] = true;
+  }
+
+  // Converts to `std::string` type.
+  const std::string body = body_json.dump();
+
+  return body;
+}
+
+// Whether `T` is a `BatchArgs` of arguments with a `JsonSchema`.
+template <typename T>
+struct IsJsonBatchArgs : std::false_type {};
+
+template <typename T>
+struct IsJsonBatchArgs<BatchArgs<T>> : std::bool_constant<HasJsonFields<T>> {};
+
+// Appends the same bytes as `MakeBodyFromJsonTree()` to `body`, written straight from the `JsonSchema`s of the
+// arguments and the options, without building the tree.
+template <typename T>
+void AppendBodyFromJson(std::string& body, const T& other_args, const ExtendedOptions& extended_options) {
+  static constexpr bool kStream = true;
+
+  if constexpr (IsJsonBatchArgs<T>::value) {
+    // The `inputs` of the batch replace those of `other_args`.
+    const JsonExtraField extra_fields[] = {
+        MakeJsonExtraField("inputs", other_args.inputs),
+        MakeJsonExtraField("options", extended_options),
+        MakeJsonExtraField("stream", kStream),
+    };
+    body.reserve(body.size() + EstimateJsonSize(other_args.other_args) + EstimateJsonSize(other_args.inputs) + 128);
+    AppendJsonObject(body, other_args.other_args, std::span(extra_fields).first(extended_options.stream ? 3 : 2));
+  } else if constexpr (HasJsonFields<T>) {
+    const JsonExtraField extra_fields[] = {
+        MakeJsonExtraField("options", extended_options),
+        MakeJsonExtraField("stream", kStream),
+    };
+    body.reserve(body.size() + EstimateJsonSize(other_args) + 128);
+    AppendJsonObject(body, other_args, std::span(extra_fields).first(extended_options.stream ? 2 : 1));
+  } else {
+    body += MakeBodyFromJsonTree(other_args, extended_options);
+  }
+}
+
+// Serializes the arguments of a task and its options into the JSON body of the request.
+template <typename T>
+std::string MakeBodyFromJson(const T& other_args, const ExtendedOptions& extended_options) {
+  std::string body;
+  AppendBodyFromJson(body, other_args, extended_options);
+  return body;
+}
+
+}  // namespace huggingface_api_cpp::inference
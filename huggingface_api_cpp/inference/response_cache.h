@@ -0,0 +1,160 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "huggingface_api_cpp/inference/args.h"
+#include "huggingface_api_cpp/inference/cache_key.h"
+
+namespace huggingface_api_cpp::inference {
+
+struct ResponseCacheConfig {
+  std::size_t max_bytes = 64 * 1024 * 1024;  // Total size of the cached responses, split evenly across the shards.
+  std::chrono::seconds ttl = std::chrono::seconds(300);
+  std::size_t num_shards = 16;
+};
+
+struct ResponseCacheStats {
+  std::uint64_t hits = 0;
+  std::uint64_t misses = 0;
+  std::uint64_t evictions = 0;  // Entries dropped for exceeding the size cap or the TTL.
+  std::size_t bytes = 0;
+};
+
+// A bounded in-memory LRU cache of response bodies. Sharded by key, each shard with its own lock.
+class ResponseCache {
+ public:
+  ResponseCache(const ResponseCacheConfig& config = ResponseCacheConfig())
+      : config_(config), shards_(std::max<std::size_t>(config.num_shards, 1)) {}
+
+  ResponseCache(const ResponseCache&) = delete;
+  ResponseCache& operator=(const ResponseCache&) = delete;
+
+  std::optional<std::string> get(const CacheKey& cache_key) {
+    Shard& shard = shardOf(cache_key);
+    const auto now = std::chrono::steady_clock::now();
+
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.index.find(cache_key.hash);
+    if (it == shard.index.end() || it->second->cache_key.check != cache_key.check) {
+      misses_.fetch_add(1, std::memory_order_relaxed);
+      return std::nullopt;
+    }
+    if (it->second->expires_at <= now) {
+      erase(shard, it->second);
+      evictions_.fetch_add(1, std::memory_order_relaxed);
+      misses_.fetch_add(1, std::memory_order_relaxed);
+      return std::nullopt;
+    }
+
+    // Moves the entry to the front, i.e. the most recently used.
+    shard.entries.splice(shard.entries.begin(), shard.entries, it->second);
+    hits_.fetch_add(1, std::memory_order_relaxed);
+    return it->second->value;
+  }
+
+  void put(const CacheKey& cache_key, const std::string& value) {
+    const std::size_t max_shard_bytes = config_.max_bytes / shards_.size();
+    if (max_shard_bytes < value.size()) {
+      return;
+    }
+
+    Shard& shard = shardOf(cache_key);
+    const auto expires_at = std::chrono::steady_clock::now() + config_.ttl;
+
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.index.find(cache_key.hash);
+    if (it != shard.index.end()) {
+      erase(shard, it->second);
+    }
+
+    shard.entries.push_front({cache_key, value, expires_at});
+    shard.index[cache_key.hash] = shard.entries.begin();
+    shard.bytes += value.size();
+    bytes_.fetch_add(value.size(), std::memory_order_relaxed);
+
+    while (max_shard_bytes < shard.bytes) {
+      erase(shard, std::prev(shard.entries.end()));
+      evictions_.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+
+  ResponseCacheStats stats() const {
+    ResponseCacheStats stats;
+    stats.hits = hits_.load(std::memory_order_relaxed);
+    stats.misses = misses_.load(std::memory_order_relaxed);
+    stats.evictions = evictions_.load(std::memory_order_relaxed);
+    stats.bytes = bytes_.load(std::memory_order_relaxed);
+    return stats;
+  }
+
+ private:
+  struct Entry {
+    CacheKey cache_key;
+    std::string value;
+    std::chrono::steady_clock::time_point expires_at;
+  };
+
+  struct Shard {
+    std::mutex mutex;
+    std::list<Entry> entries;  // Ordered from the most recently used.
+    std::unordered_map<std::uint64_t, std::list<Entry>::iterator> index;
+    std::size_t bytes = 0;
+  };
+
+  Shard& shardOf(const CacheKey& cache_key) {
+    return shards_[cache_key.check % shards_.size()];
+  }
+
+  void erase(Shard& shard, std::list<Entry>::iterator entry) {
+    shard.bytes -= entry->value.size();
+    bytes_.fetch_sub(entry->value.size(), std::memory_order_relaxed);
+    shard.index.erase(entry->cache_key.hash);
+    shard.entries.erase(entry);
+  }
+
+  const ResponseCacheConfig config_;
+  std::vector<Shard> shards_;
+
+  std::atomic<std::uint64_t> hits_ = 0;
+  std::atomic<std::uint64_t> misses_ = 0;
+  std::atomic<std::uint64_t> evictions_ = 0;
+  std::atomic<std::size_t> bytes_ = 0;
+};
+
+// Whether a response to `other_args` may be served from a cache, i.e. the model output is deterministic.
+template <typename T>
+bool IsCacheable(const T& other_args) {
+  return true;
+}
+
+template <typename T>
+bool IsCacheable(const BatchArgs<T>& batch_args) {
+  return IsCacheable(batch_args.other_args);
+}
+
+// Without `parameters`, the model decides whether to sample, so the output is not assumed deterministic.
+inline bool IsCacheable(const TextGenerationArgs& other_args) {
+  return other_args.parameters_opt.has_value() && !other_args.parameters_opt->do_sample_opt.value_or(false);
+}
+
+// The conversational models sample by default.
+inline bool IsCacheable(const ConversationalArgs& other_args) {
+  return false;
+}
+
+inline bool IsCacheable(const TextToImageArgs& other_args) {
+  return false;
+}
+
+}  // namespace huggingface_api_cpp::inference
@@ -0,0 +1,383 @@
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include <nlohmann/json.hpp>
+
+namespace huggingface_api_cpp::inference {
+
+// Receives the results of a streamed call one by one, as soon as each of them has been decoded.
+template <typename T>
+using ResultSink = std::function<void(T result)>;
+
+// The outcome of a call whose results were streamed to a `ResultSink`.
+struct StreamOutput {
+  long response_code = 0;  // 0 if the transfer failed, e.g. on a connection error or an exception thrown by a sink.
+  std::size_t num_results = 0;
+
+  // Empty if the whole response has been decoded. Otherwise, the error body returned by the server, or the error JSON
+  // of the library (e.g. `{"curlpp_runtime_error": ...}` or `{"stream_decode_error": ...}`).
+  std::string error = "";
+};
+
+// Decodes a JSON array of `T` incrementally, as the bytes of the response arrive. The elements are split without
+// building a tree of the array, and each one is decoded and passed to the sink as soon as its last byte is received,
+// so only the element being received is buffered.
+template <typename T>
+class ResultStreamDecoder {
+ public:
+  explicit ResultStreamDecoder(ResultSink<T> result_sink) : result_sink_(std::move(result_sink)) {}
+
+  // Malformed input stops the decoding, which is then reported by `finish()`. Exceptions thrown by the sink propagate.
+  void feed(const char* data, std::size_t size) {
+    std::size_t element_begin = 0;
+    for (std::size_t i = 0; i < size && state_ != State::kFailed; ++i) {
+      const char c = data[i];
+      switch (state_) {
+        case State::kBeforeArray:
+          if (c == '[') {
+            state_ = State::kBeforeElement;
+          } else if (!IsWhitespace(c)) {
+            fail("The response is not an array.");
+          }
+          break;
+
+        case State::kBeforeElement:
+          if (c == ']' && num_results_ == 0) {
+            state_ = State::kAfterArray;
+            break;
+          }
+          if (IsWhitespace(c)) {
+            break;
+          }
+          state_ = State::kInElement;
+          element_begin = i;
+          [[fallthrough]];
+
+        case State::kInElement:
+          if (is_in_string_) {
+            if (is_escaped_) {
+              is_escaped_ = false;
+            } else if (c == '\\') {
+              is_escaped_ = true;
+            } else if (c == '"') {
+              is_in_string_ = false;
+            }
+          } else if (c == '"') {
+            is_in_string_ = true;
+          } else if (c == '{' || c == '[') {
+            ++depth_;
+          } else if ((c == '}' || c == ']') && 0 < depth_) {
+            --depth_;
+          } else if ((c == ',' || c == ']') && depth_ == 0) {
+            element_.append(data + element_begin, i - element_begin);
+            state_ = (c == ',') ? State::kBeforeElement : State::kAfterArray;
+            decodeElement();
+          }
+          break;
+
+        case State::kAfterArray:
+          if (!IsWhitespace(c)) {
+            fail("Unexpected data after the array.");
+          }
+          break;
+
+        case State::kFailed:
+          break;
+      }
+    }
+
+    // Keeps the part of the element received so far.
+    if (state_ == State::kInElement) {
+      element_.append(data + element_begin, size - element_begin);
+    }
+  }
+
+  // Returns whether the whole array has been decoded. Otherwise, `error()` holds the error JSON.
+  bool finish() {
+    if (state_ != State::kAfterArray && state_ != State::kFailed) {
+      fail("The response ended before the end of the array.");
+    }
+    return state_ == State::kAfterArray;
+  }
+
+  const std::string& error() const {
+    return error_;
+  }
+
+  std::size_t numResults() const {
+    return num_results_;
+  }
+
+ private:
+  enum class State {
+    kBeforeArray,
+    kBeforeElement,
+    kInElement,
+    kAfterArray,
+    kFailed,
+  };
+
+  static bool IsWhitespace(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+  }
+
+  void decodeElement() {
+    const nlohmann::json element_json = nlohmann::json::parse(element_, nullptr, /*allow_exceptions=*/false);
+    // Keeps the capacity, which is reused by the next element.
+    element_.clear();
+    if (element_json.is_discarded()) {
+      fail("Malformed element.");
+      return;
+    }
+
+    T result;
+    try {
+      element_json.get_to(result);
+    }
+    catch (const nlohmann::json::exception& e) {
+      fail(e.what());
+      return;
+    }
+    ++num_results_;
+    result_sink_(std::move(result));
+  }
+
+  void fail(const std::string& reason) {
+    state_ = State::kFailed;
+    const nlohmann::json stream_decode_error_json{
+        {"stream_decode_error", reason},
+    };
+    error_ = stream_decode_error_json.dump();
+    element_.clear();
+    element_.shrink_to_fit();
+  }
+
+  ResultSink<T> result_sink_;
+  State state_ = State::kBeforeArray;
+  std::string element_;
+  int depth_ = 0;
+  bool is_in_string_ = false;
+  bool is_escaped_ = false;
+  std::size_t num_results_ = 0;
+  std::string error_;
+};
+
+// Decodes a server-sent event stream (`text/event-stream`) incrementally, as the bytes of the response arrive. The
+// data of each event is decoded from JSON into `T` and passed to the sink as soon as the event has been received. An
+// event whose data is an error object (e.g. `{"error": ...}`) stops the decoding.
+template <typename T>
+class EventStreamDecoder {
+ public:
+  explicit EventStreamDecoder(ResultSink<T> result_sink) : result_sink_(std::move(result_sink)) {}
+
+  // Malformed input stops the decoding, which is then reported by `finish()`. Exceptions thrown by the sink propagate.
+  void feed(const char* data, std::size_t size) {
+    std::size_t line_begin = 0;
+    for (std::size_t i = 0; i < size && error_.empty(); ++i) {
+      if (data[i] != '\n') {
+        continue;
+      }
+      std::string_view line(data + line_begin, i - line_begin);
+      if (!line_.empty()) {
+        line_.append(line);
+        line = line_;
+      }
+      if (!line.empty() && line.back() == '\r') {
+        line.remove_suffix(1);
+      }
+      decodeLine(line);
+      line_.clear();
+      line_begin = i + 1;
+    }
+
+    // Keeps the part of the line received so far.
+    if (error_.empty()) {
+      line_.append(data + line_begin, size - line_begin);
+    }
+  }
+
+  // Returns whether the stream has ended cleanly. Otherwise, `error()` holds the error JSON.
+  bool finish() {
+    if (error_.empty() && (!line_.empty() || !data_.empty())) {
+      fail("The response ended in the middle of an event.");
+    }
+    return error_.empty();
+  }
+
+  const std::string& error() const {
+    return error_;
+  }
+
+  std::size_t numResults() const {
+    return num_results_;
+  }
+
+ private:
+  void decodeLine(std::string_view line) {
+    // A blank line dispatches the event. Lines starting with ':' are comments, and the fields other than "data"
+    // (e.g. "event", "id" and "retry") are not used.
+    if (line.empty()) {
+      if (!data_.empty()) {
+        decodeEvent();
+      }
+      return;
+    }
+    if (line.substr(0, 5) != "data:") {
+      return;
+    }
+    line.remove_prefix(5);
+    if (!line.empty() && line.front() == ' ') {
+      line.remove_prefix(1);
+    }
+    if (!data_.empty()) {
+      data_ += '\n';
+    }
+    data_.append(line);
+  }
+
+  void decodeEvent() {
+    // Some servers terminate the stream with an explicit sentinel.
+    if (data_ == "[DONE]") {
+      data_.clear();
+      return;
+    }
+
+    const nlohmann::json data_json = nlohmann::json::parse(data_, nullptr, /*allow_exceptions=*/false);
+    if (data_json.is_discarded()) {
+      fail("Malformed event.");
+      return;
+    }
+    if (data_json.is_object() && data_json.contains("error")) {
+      // Reported as the error body returned by the server.
+      error_ = std::move(data_);
+      data_.clear();
+      return;
+    }
+    data_.clear();
+
+    T result;
+    try {
+      data_json.get_to(result);
+    }
+    catch (const nlohmann::json::exception& e) {
+      fail(e.what());
+      return;
+    }
+    ++num_results_;
+    result_sink_(std::move(result));
+  }
+
+  void fail(const std::string& reason) {
+    const nlohmann::json stream_decode_error_json{
+        {"stream_decode_error", reason},
+    };
+    error_ = stream_decode_error_json.dump();
+    line_.clear();
+    data_.clear();
+  }
+
+  ResultSink<T> result_sink_;
+  std::string line_;  // The incomplete line carried over from the previous chunk.
+  std::string data_;  // The data of the event being received.
+  std::size_t num_results_ = 0;
+  std::string error_;
+};
+
+// The results of a streamed call, consumed in order by one thread while the transfer runs on the thread pool.
+// At most `capacity` results are buffered: beyond that, the thread performing the transfer waits for the consumer, so
+// the server is only read as fast as the results are consumed. Destroying the stream cancels the transfer.
+template <typename T>
+class ResultStream {
+ public:
+  // The state shared with the thread performing the transfer.
+  class Channel {
+   public:
+    explicit Channel(std::size_t capacity) : capacity_(std::max<std::size_t>(capacity, 1)) {}
+
+    // Blocks while the buffer is full. Throws if the consumer has gone, which aborts the transfer.
+    void push(T result) {
+      std::unique_lock<std::mutex> lock(mutex_);
+      not_full_cv_.wait(lock, [this]() { return results_.size() < capacity_ || is_cancelled_; });
+      if (is_cancelled_) {
+        throw std::runtime_error("The result stream has been destroyed.");
+      }
+      results_.push_back(std::move(result));
+      not_empty_cv_.notify_one();
+    }
+
+    void close(StreamOutput stream_output) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stream_output_opt_ = std::move(stream_output);
+      not_empty_cv_.notify_one();
+    }
+
+   private:
+    friend class ResultStream;
+
+    void cancel() {
+      std::lock_guard<std::mutex> lock(mutex_);
+      is_cancelled_ = true;
+      not_full_cv_.notify_one();
+    }
+
+    const std::size_t capacity_;
+    std::mutex mutex_;
+    std::condition_variable not_empty_cv_;
+    std::condition_variable not_full_cv_;
+    std::deque<T> results_;
+    std::optional<StreamOutput> stream_output_opt_;
+    bool is_cancelled_ = false;
+  };
+
+  explicit ResultStream(std::shared_ptr<Channel> channel) : channel_(std::move(channel)) {}
+
+  ResultStream(ResultStream&& other) = default;
+  ResultStream& operator=(ResultStream&& other) = delete;
+
+  ~ResultStream() {
+    if (channel_) {
+      channel_->cancel();
+    }
+  }
+
+  // Blocks until the next result has been received. Returns std::nullopt once the call has ended, after which
+  // `output()` tells whether it completed.
+  std::optional<T> next() {
+    std::unique_lock<std::mutex> lock(channel_->mutex_);
+    channel_->not_empty_cv_.wait(lock, [this]() {
+      return !channel_->results_.empty() || channel_->stream_output_opt_.has_value();
+    });
+    if (channel_->results_.empty()) {
+      return std::nullopt;
+    }
+    T result = std::move(channel_->results_.front());
+    channel_->results_.pop_front();
+    channel_->not_full_cv_.notify_one();
+    return result;
+  }
+
+  // Blocks until the call has ended. To be called once `next()` has returned std::nullopt, since the call cannot end
+  // while the buffer is full.
+  StreamOutput output() {
+    std::unique_lock<std::mutex> lock(channel_->mutex_);
+    channel_->not_empty_cv_.wait(lock, [this]() { return channel_->stream_output_opt_.has_value(); });
+    return channel_->stream_output_opt_.value();
+  }
+
+ private:
+  std::shared_ptr<Channel> channel_;
+};
+
+}  // namespace huggingface_api_cpp::inference
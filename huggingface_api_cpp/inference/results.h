@@ -0,0 +1,268 @@
+#pragma once
+
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+namespace huggingface_api_cpp::inference {
+
+// The decoded output of a call. Holds either the value or, if the output string could not be decoded into `T`
+// (e.g. `{"error": ...}` returned by the server, or a `{"curlpp_runtime_error": ...}` of the library), that string.
+template <typename T>
+struct Result {
+  std::optional<T> value_opt = std::nullopt;
+  std::string error = "";
+};
+
+// Decodes `output_string` into `T`, e.g. the output of an `*Async()` call.
+template <typename T>
+Result<T> ParseResult(std::string output_string) {
+  Result<T> result;
+  const nlohmann::json json = nlohmann::json::parse(output_string, nullptr, /*allow_exceptions=*/false);
+  if (!json.is_discarded()) {
+    try {
+      result.value_opt = json.get<T>();
+      return result;
+    }
+    catch (const nlohmann::json::exception& e) {
+      // Not a `T`, e.g. an error object.
+    }
+  }
+  result.error = std::move(output_string);
+  return result;
+}
+
+/////////////////////////////////
+// Natural Language Processing //
+/////////////////////////////////
+
+struct FillMaskResult {
+  std::string sequence = "";
+  double score = 0.0;
+  int token = 0;
+  std::string token_str = "";
+};
+
+void from_json(const nlohmann::json& json, FillMaskResult& result) {
+  json.at("sequence").get_to(result.sequence);
+  json.at("score").get_to(result.score);
+  json.at("token").get_to(result.token);
+  json.at("token_str").get_to(result.token_str);
+}
+
+struct SummarizationResult {
+  std::string summary_text = "";
+};
+
+void from_json(const nlohmann::json& json, SummarizationResult& result) {
+  json.at("summary_text").get_to(result.summary_text);
+}
+
+struct QuestionAnswerResult {
+  std::string answer = "";
+  double score = 0.0;
+  int start = 0;
+  int end = 0;
+};
+
+void from_json(const nlohmann::json& json, QuestionAnswerResult& result) {
+  json.at("answer").get_to(result.answer);
+  json.at("score").get_to(result.score);
+  json.at("start").get_to(result.start);
+  json.at("end").get_to(result.end);
+}
+
+struct TableQuestionAnswerResult {
+  std::string answer = "";
+  std::vector<std::vector<int>> coordinates = {};
+  std::vector<std::string> cells = {};
+  std::optional<std::string> aggregator_opt = std::nullopt;
+};
+
+void from_json(const nlohmann::json& json, TableQuestionAnswerResult& result) {
+  json.at("answer").get_to(result.answer);
+  json.at("coordinates").get_to(result.coordinates);
+  json.at("cells").get_to(result.cells);
+
+  if (json.contains("aggregator")) {
+    result.aggregator_opt = json.at("aggregator").get<std::string>();
+  }
+}
+
+// A label with its score, as output by the text, audio and image classification tasks.
+struct ClassificationResult {
+  std::string label = "";
+  double score = 0.0;
+};
+
+void from_json(const nlohmann::json& json, ClassificationResult& result) {
+  json.at("label").get_to(result.label);
+  json.at("score").get_to(result.score);
+}
+
+using TextClassificationResult = ClassificationResult;
+
+struct TextGenerationResult {
+  std::string generated_text = "";
+};
+
+void from_json(const nlohmann::json& json, TextGenerationResult& result) {
+  json.at("generated_text").get_to(result.generated_text);
+}
+
+// One event of a streamed `textGeneration()` or `conversational()` call, which carries one generated token.
+struct TokenStreamResult {
+  struct Token {
+    int id = 0;
+    std::string text = "";
+    double logprob = 0.0;
+    bool special = false;
+  };
+
+  Token token = {};
+  std::optional<std::string> generated_text_opt = std::nullopt;  // The whole text, set on the last event only.
+};
+
+void from_json(const nlohmann::json& json, TokenStreamResult::Token& token) {
+  json.at("id").get_to(token.id);
+  json.at("text").get_to(token.text);
+  if (json.contains("logprob") && json.at("logprob").is_number()) {
+    json.at("logprob").get_to(token.logprob);
+  }
+  if (json.contains("special")) {
+    json.at("special").get_to(token.special);
+  }
+}
+
+void from_json(const nlohmann::json& json, TokenStreamResult& result) {
+  json.at("token").get_to(result.token);
+
+  if (json.contains("generated_text") && json.at("generated_text").is_string()) {
+    result.generated_text_opt = json.at("generated_text").get<std::string>();
+  }
+}
+
+struct TokenClassificationResult {
+  std::string entity_group = "";
+  double score = 0.0;
+  std::string word = "";
+  int start = 0;
+  int end = 0;
+};
+
+void from_json(const nlohmann::json& json, TokenClassificationResult& result) {
+  // Without aggregation, the entity is output as "entity" instead of "entity_group".
+  json.at(json.contains("entity_group") ? "entity_group" : "entity").get_to(result.entity_group);
+  json.at("score").get_to(result.score);
+  json.at("word").get_to(result.word);
+  json.at("start").get_to(result.start);
+  json.at("end").get_to(result.end);
+}
+
+struct TranslationResult {
+  std::string translation_text = "";
+};
+
+void from_json(const nlohmann::json& json, TranslationResult& result) {
+  json.at("translation_text").get_to(result.translation_text);
+}
+
+struct ZeroShotClassificationResult {
+  std::string sequence = "";
+  std::vector<std::string> labels = {};  // Sorted by descending score.
+  std::vector<double> scores = {};
+};
+
+void from_json(const nlohmann::json& json, ZeroShotClassificationResult& result) {
+  json.at("sequence").get_to(result.sequence);
+  json.at("labels").get_to(result.labels);
+  json.at("scores").get_to(result.scores);
+}
+
+struct ConversationalResult {
+  struct Conversation {
+    std::vector<std::string> past_user_inputs = {};
+    std::vector<std::string> generated_responses = {};
+  };
+
+  std::string generated_text = "";
+  Conversation conversation = {};
+  std::vector<std::string> warnings = {};
+};
+
+void from_json(const nlohmann::json& json, ConversationalResult::Conversation& conversation) {
+  json.at("past_user_inputs").get_to(conversation.past_user_inputs);
+  json.at("generated_responses").get_to(conversation.generated_responses);
+}
+
+void from_json(const nlohmann::json& json, ConversationalResult& result) {
+  json.at("generated_text").get_to(result.generated_text);
+  json.at("conversation").get_to(result.conversation);
+
+  if (json.contains("warnings")) {
+    json.at("warnings").get_to(result.warnings);
+  }
+}
+
+//////////////////////
+// Audio Processing //
+//////////////////////
+
+struct AutomaticSpeechRecognitionResult {
+  std::string text = "";
+};
+
+void from_json(const nlohmann::json& json, AutomaticSpeechRecognitionResult& result) {
+  json.at("text").get_to(result.text);
+}
+
+using AudioClassificationResult = ClassificationResult;
+
+/////////////////////
+// Computer Vision //
+/////////////////////
+
+using ImageClassificationResult = ClassificationResult;
+
+struct ObjectDetectionResult {
+  struct Box {
+    int xmin = 0;
+    int ymin = 0;
+    int xmax = 0;
+    int ymax = 0;
+  };
+
+  std::string label = "";
+  double score = 0.0;
+  Box box = {};
+};
+
+void from_json(const nlohmann::json& json, ObjectDetectionResult::Box& box) {
+  json.at("xmin").get_to(box.xmin);
+  json.at("ymin").get_to(box.ymin);
+  json.at("xmax").get_to(box.xmax);
+  json.at("ymax").get_to(box.ymax);
+}
+
+void from_json(const nlohmann::json& json, ObjectDetectionResult& result) {
+  json.at("label").get_to(result.label);
+  json.at("score").get_to(result.score);
+  json.at("box").get_to(result.box);
+}
+
+struct ImageSegmentationResult {
+  std::string label = "";
+  double score = 0.0;
+  std::string mask = "";  // A base64-encoded PNG image.
+};
+
+void from_json(const nlohmann::json& json, ImageSegmentationResult& result) {
+  json.at("label").get_to(result.label);
+  json.at("score").get_to(result.score);
+  json.at("mask").get_to(result.mask);
+}
+
+}  // namespace huggingface_api_cpp::inference
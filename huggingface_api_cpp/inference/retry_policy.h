@@ -0,0 +1,121 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <vector>
+
+#include <curl/curl.h>
+
+namespace huggingface_api_cpp::inference {
+
+struct RetryBudgetStats {
+  std::uint64_t retries = 0;           // Retries allowed by the budget.
+  std::uint64_t rejected_retries = 0;  // Retries denied because the budget was exhausted.
+};
+
+// Limits the retries of all the calls sharing it to a fraction of their first attempts, so that a degraded endpoint
+// does not receive a retry storm on top of its normal load. Each first attempt deposits `retry_ratio` tokens and
+// each retry withdraws one. `min_retries_per_second` tokens are added over time, so that a client with little traffic
+// can still retry.
+class RetryBudget {
+ public:
+  RetryBudget(double retry_ratio = 0.1, double min_retries_per_second = 10.0, double max_tokens = 100.0)
+      : retry_ratio_(retry_ratio),
+        min_retries_per_second_(min_retries_per_second),
+        max_tokens_(max_tokens),
+        tokens_(max_tokens),
+        refill_time_(std::chrono::steady_clock::now()) {}
+
+  RetryBudget(const RetryBudget&) = delete;
+  RetryBudget& operator=(const RetryBudget&) = delete;
+
+  // The budget shared by all the calls of the process, unless their `RetryPolicy` has its own.
+  static const std::shared_ptr<RetryBudget>& Global() {
+    static const std::shared_ptr<RetryBudget> kGlobal = std::make_shared<RetryBudget>();
+    return kGlobal;
+  }
+
+  void recordFirstAttempt() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    tokens_ = std::min(tokens_ + retry_ratio_, max_tokens_);
+  }
+
+  // Returns whether a retry may be made, and withdraws its token if so.
+  bool tryRetry() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    const std::chrono::duration<double> elapsed_time = now - refill_time_;
+    tokens_ = std::min(tokens_ + elapsed_time.count() * min_retries_per_second_, max_tokens_);
+    refill_time_ = now;
+
+    if (tokens_ < 1.0) {
+      ++stats_.rejected_retries;
+      return false;
+    }
+    tokens_ -= 1.0;
+    ++stats_.retries;
+    return true;
+  }
+
+  RetryBudgetStats stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+  }
+
+ private:
+  const double retry_ratio_;
+  const double min_retries_per_second_;
+  const double max_tokens_;
+
+  mutable std::mutex mutex_;
+  double tokens_;
+  std::chrono::steady_clock::time_point refill_time_;
+  RetryBudgetStats stats_;
+};
+
+// When and how often a failed call is retried, if `Options::retry_on_error` is set.
+// A 503 response retried without `Options::wait_for_model` is retried with it, since the model is likely loading.
+struct RetryPolicy {
+  std::size_t max_attempts = 4;  // Including the first attempt.
+  std::vector<long> retryable_response_codes = {429, 500, 502, 503, 504};
+
+  // Transfers aborted by an exception of a sink (or streamed to a sink) are never retried, since the sink has already
+  // received a part of the response.
+  std::vector<CURLcode> retryable_curl_codes = {
+      CURLE_COULDNT_RESOLVE_HOST, CURLE_COULDNT_CONNECT, CURLE_OPERATION_TIMEDOUT,
+      CURLE_SEND_ERROR,           CURLE_RECV_ERROR,      CURLE_GOT_NOTHING,
+  };
+
+  // The delay before the n-th retry is drawn uniformly from [0, min(max_backoff, initial_backoff * multiplier^(n-1))]
+  // ("full jitter"), so that the retries of calls failing together do not hit the server together again.
+  std::chrono::milliseconds initial_backoff = std::chrono::milliseconds(100);
+  std::chrono::milliseconds max_backoff = std::chrono::seconds(10);
+  double backoff_multiplier = 2.0;
+
+  // The time after the first attempt beyond which no retry is started. Zero means no deadline.
+  std::chrono::milliseconds deadline = std::chrono::milliseconds(0);
+
+  // Shared by the calls to limit their retries together. nullptr means unlimited.
+  std::shared_ptr<RetryBudget> budget = RetryBudget::Global();
+};
+
+// The jittered delay before the `num_retries`-th retry (starting at 1).
+inline std::chrono::milliseconds RetryBackoff(const RetryPolicy& retry_policy, std::size_t num_retries) {
+  const double exponent = static_cast<double>(std::max<std::size_t>(num_retries, 1) - 1);
+  const double max_backoff_ms = static_cast<double>(retry_policy.max_backoff.count());
+  const double backoff_ms = std::min(
+      static_cast<double>(retry_policy.initial_backoff.count()) * std::pow(retry_policy.backoff_multiplier, exponent),
+      max_backoff_ms);
+
+  thread_local std::mt19937_64 random_engine(std::random_device{}());
+  std::uniform_real_distribution<double> distribution(0.0, std::max(backoff_ms, 0.0));
+  return std::chrono::milliseconds(static_cast<std::chrono::milliseconds::rep>(distribution(random_engine)));
+}
+
+}  // namespace huggingface_api_cpp::inference
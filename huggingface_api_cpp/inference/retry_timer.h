@@ -0,0 +1,99 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace huggingface_api_cpp::inference {
+
+// Runs tasks after a delay on one timer thread, e.g. the retries and the rate-limited sends of calls performed by a
+// non-blocking transport.
+// The tasks must be short and must not block. The thread is spawned lazily on the first `schedule()`.
+class RetryTimer {
+ public:
+  using Task = std::function<void()>;
+
+  RetryTimer() = default;
+
+  RetryTimer(const RetryTimer&) = delete;
+  RetryTimer& operator=(const RetryTimer&) = delete;
+
+  // Runs all the scheduled tasks without waiting for their time, then joins the thread.
+  ~RetryTimer() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stopping_ = true;
+    }
+    task_scheduled_cv_.notify_one();
+    if (thread_.joinable()) {
+      thread_.join();
+    }
+  }
+
+  // Once the timer is stopping and drained, `task` is run on the calling thread instead.
+  void schedule(std::chrono::milliseconds delay, Task task) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (!is_drained_) {
+        if (!thread_.joinable()) {
+          thread_ = std::thread([this]() { run(); });
+        }
+        tasks_.push(ScheduledTask{std::chrono::steady_clock::now() + delay, next_sequence_++, std::move(task)});
+        task_scheduled_cv_.notify_one();
+        return;
+      }
+    }
+    task();
+  }
+
+ private:
+  struct ScheduledTask {
+    std::chrono::steady_clock::time_point time;
+    std::uint64_t sequence;  // Keeps the tasks scheduled for the same time in order.
+    Task task;
+
+    bool operator>(const ScheduledTask& other) const {
+      return time != other.time ? time > other.time : sequence > other.sequence;
+    }
+  };
+
+  void run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+      if (tasks_.empty()) {
+        if (stopping_) {
+          is_drained_ = true;
+          return;
+        }
+        task_scheduled_cv_.wait(lock);
+        continue;
+      }
+      if (!stopping_ && std::chrono::steady_clock::now() < tasks_.top().time) {
+        task_scheduled_cv_.wait_until(lock, tasks_.top().time);
+        continue;
+      }
+
+      Task task = std::move(const_cast<ScheduledTask&>(tasks_.top()).task);
+      tasks_.pop();
+      lock.unlock();
+      task();
+      lock.lock();
+    }
+  }
+
+  std::mutex mutex_;
+  std::condition_variable task_scheduled_cv_;
+  std::priority_queue<ScheduledTask, std::vector<ScheduledTask>, std::greater<ScheduledTask>> tasks_;
+  std::uint64_t next_sequence_ = 0;
+  std::thread thread_;
+  bool stopping_ = false;
+  bool is_drained_ = false;
+};
+
+}  // namespace huggingface_api_cpp::inference
@@ -0,0 +1,255 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "huggingface_api_cpp/inference/metrics.h"
+
+namespace huggingface_api_cpp::inference {
+
+enum class Priority {
+  kHigh,  // E.g. interactive traffic.
+  kNormal,
+  kLow,   // E.g. backfills.
+};
+
+inline constexpr std::size_t kNumPriorities = 3;
+
+// How a call is scheduled by the `Scheduler`, if enabled. The deadline applies either way: a call whose deadline has
+// passed before its request is sent fails with a "deadline_exceeded" error instead, and is not retried past it.
+struct SchedulingPolicy {
+  Priority priority = Priority::kNormal;
+  std::string tenant = "";  // The calls of a class are shared fairly among the tenants. Empty means the model.
+  std::optional<std::chrono::steady_clock::time_point> deadline_opt = std::nullopt;
+};
+
+struct SchedulerConfig {
+  std::size_t max_in_flight = 64;  // Requests sent and not completed yet, over all the classes.
+
+  // The share of `max_in_flight` each class may take, so that the slots of a burst of low-priority calls free up
+  // for the next high-priority ones. Indexed by `Priority`.
+  std::array<double, kNumPriorities> max_in_flight_shares = {1.0, 1.0, 0.75};
+
+  // The calls of each tenant get slots in proportion to its weight, among the tenants with calls waiting in the
+  // same class. Tenants not listed weigh 1.
+  std::map<std::string, double> tenant_weights = {};
+};
+
+struct SchedulerStats {
+  std::size_t in_flight = 0;
+  std::size_t queue_depth = 0;  // Calls waiting for a slot.
+  std::uint64_t granted = 0;
+  std::uint64_t expired = 0;  // Calls dropped because their deadline passed while waiting.
+
+  // From the request for a slot to its grant, of the granted calls.
+  LatencyHistogramSnapshot queue_wait;
+};
+
+// Grants a bounded number of in-flight slots to the calls, by strict priority between the classes, and by weighted
+// fair queueing between the tenants of a class: each call is tagged with the virtual time its tenant would finish at
+// if served at its weight, and the smallest tag is served first. The calls whose deadline passes while they wait are
+// dropped without taking a slot.
+class Scheduler {
+ public:
+  using Clock = std::chrono::steady_clock;
+  using Task = std::function<void(bool is_granted)>;
+
+  Scheduler(const SchedulerConfig& config = SchedulerConfig()) : config_(config) {}
+
+  Scheduler(const Scheduler&) = delete;
+  Scheduler& operator=(const Scheduler&) = delete;
+
+  // Runs `task` with true once a slot is granted, or with false if the deadline of `scheduling_policy` passes first:
+  // on the calling thread if decided now, or else on the thread of the next `release()` or `dropExpired()`. The task
+  // must be short and must not block. `tenant` is the tenant of the policy or else the model of the call.
+  void acquire(const SchedulingPolicy& scheduling_policy, const std::string& tenant, Task task) {
+    std::vector<std::pair<Task, bool>> decided_tasks;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      const Clock::time_point now = Clock::now();
+      Class& scheduling_class = classes_[static_cast<std::size_t>(scheduling_policy.priority)];
+      if (scheduling_policy.deadline_opt.has_value() && scheduling_policy.deadline_opt.value() <= now) {
+        ++scheduling_class.expired;
+        decided_tasks.emplace_back(std::move(task), false);
+      } else {
+        enqueue(scheduling_class, scheduling_policy, tenant, std::move(task), now);
+        grant(now, decided_tasks);
+      }
+    }
+    for (auto& [task, is_granted] : decided_tasks) {
+      task(is_granted);
+    }
+  }
+
+  // Blocks the calling thread until a slot is granted, and returns true, or until the deadline passes, and returns
+  // false.
+  bool acquire(const SchedulingPolicy& scheduling_policy, const std::string& tenant) {
+    std::promise<bool> grant_promise;
+    std::future<bool> grant_ftr = grant_promise.get_future();
+    acquire(scheduling_policy, tenant, [&grant_promise](bool is_granted) {
+      grant_promise.set_value(is_granted);
+    });
+    if (scheduling_policy.deadline_opt.has_value() &&
+        grant_ftr.wait_until(scheduling_policy.deadline_opt.value()) == std::future_status::timeout) {
+      dropExpired();
+    }
+    return grant_ftr.get();
+  }
+
+  // Frees a slot granted to a call of `priority`.
+  void release(Priority priority) {
+    std::vector<std::pair<Task, bool>> decided_tasks;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      --in_flight_;
+      --classes_[static_cast<std::size_t>(priority)].in_flight;
+      grant(Clock::now(), decided_tasks);
+    }
+    for (auto& [task, is_granted] : decided_tasks) {
+      task(is_granted);
+    }
+  }
+
+  // Drops the waiting calls whose deadline has passed, e.g. from a timer set to the deadline of a call, since they
+  // are otherwise only dropped when a slot is requested or released.
+  void dropExpired() {
+    std::vector<std::pair<Task, bool>> decided_tasks;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      dropExpired(Clock::now(), decided_tasks);
+    }
+    for (auto& [task, is_granted] : decided_tasks) {
+      task(is_granted);
+    }
+  }
+
+  std::map<Priority, SchedulerStats> stats() const {
+    std::map<Priority, SchedulerStats> stats;
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (std::size_t i = 0; i < kNumPriorities; ++i) {
+      const Class& scheduling_class = classes_[i];
+      stats[static_cast<Priority>(i)] = SchedulerStats{
+          scheduling_class.in_flight, scheduling_class.waiters.size(), scheduling_class.granted,
+          scheduling_class.expired, scheduling_class.queue_wait.snapshot(),
+      };
+    }
+    return stats;
+  }
+
+ private:
+  // Ordered by virtual finish time, then by arrival.
+  using WaiterKey = std::pair<double, std::uint64_t>;
+
+  struct Waiter {
+    Task task;
+    Clock::time_point enqueue_time;
+    std::optional<Clock::time_point> deadline_opt;
+  };
+
+  struct Class {
+    std::size_t in_flight = 0;
+    std::map<WaiterKey, Waiter> waiters;
+    double virtual_time = 0.0;
+    std::unordered_map<std::string, double> tenant_finish_times;  // Of the last call of each tenant.
+    std::uint64_t granted = 0;
+    std::uint64_t expired = 0;
+    LatencyHistogram queue_wait;
+  };
+
+  // Above this many tenants, those that no longer hold back their next call are forgotten.
+  static constexpr std::size_t kMaxTrackedTenants = 1024;
+
+  void enqueue(Class& scheduling_class, const SchedulingPolicy& scheduling_policy, const std::string& tenant,
+               Task task, Clock::time_point now) {
+    auto weight_it = config_.tenant_weights.find(tenant);
+    const double weight = weight_it != config_.tenant_weights.end() ? std::max(weight_it->second, 1e-6) : 1.0;
+    double& finish_time = scheduling_class.tenant_finish_times[tenant];
+    finish_time = std::max(finish_time, scheduling_class.virtual_time) + 1.0 / weight;
+
+    const WaiterKey key{finish_time, next_sequence_++};
+    scheduling_class.waiters.emplace(key, Waiter{std::move(task), now, scheduling_policy.deadline_opt});
+    if (scheduling_policy.deadline_opt.has_value()) {
+      deadlines_.emplace(scheduling_policy.deadline_opt.value(), static_cast<std::size_t>(scheduling_policy.priority),
+                         key);
+    }
+  }
+
+  // Grants the free slots to the waiting calls, by priority. Collects the tasks to run once unlocked.
+  void grant(Clock::time_point now, std::vector<std::pair<Task, bool>>& decided_tasks) {
+    dropExpired(now, decided_tasks);
+    for (std::size_t i = 0; i < kNumPriorities && in_flight_ < config_.max_in_flight; ++i) {
+      Class& scheduling_class = classes_[i];
+      const std::size_t max_class_in_flight = std::max<std::size_t>(
+          static_cast<std::size_t>(std::ceil(config_.max_in_flight_shares[i] * config_.max_in_flight)), 1);
+      while (!scheduling_class.waiters.empty() && in_flight_ < config_.max_in_flight &&
+             scheduling_class.in_flight < max_class_in_flight) {
+        auto node = scheduling_class.waiters.extract(scheduling_class.waiters.begin());
+        Waiter& waiter = node.mapped();
+        if (waiter.deadline_opt.has_value()) {
+          deadlines_.erase(std::make_tuple(waiter.deadline_opt.value(), i, node.key()));
+        }
+        scheduling_class.virtual_time = std::max(scheduling_class.virtual_time, node.key().first);
+        ++in_flight_;
+        ++scheduling_class.in_flight;
+        ++scheduling_class.granted;
+        scheduling_class.queue_wait.record(
+            std::chrono::duration_cast<std::chrono::microseconds>(now - waiter.enqueue_time));
+        decided_tasks.emplace_back(std::move(waiter.task), true);
+      }
+      forgetIdleTenants(scheduling_class);
+    }
+  }
+
+  void dropExpired(Clock::time_point now, std::vector<std::pair<Task, bool>>& decided_tasks) {
+    while (!deadlines_.empty() && std::get<0>(*deadlines_.begin()) <= now) {
+      const auto [deadline, priority_index, key] = *deadlines_.begin();
+      deadlines_.erase(deadlines_.begin());
+      Class& scheduling_class = classes_[priority_index];
+      auto node = scheduling_class.waiters.extract(key);
+      if (!node.empty()) {
+        ++scheduling_class.expired;
+        decided_tasks.emplace_back(std::move(node.mapped().task), false);
+      }
+    }
+  }
+
+  // A tenant whose last finish time is behind the virtual time starts from the virtual time anyway.
+  void forgetIdleTenants(Class& scheduling_class) {
+    if (scheduling_class.waiters.empty()) {
+      scheduling_class.tenant_finish_times.clear();
+      scheduling_class.virtual_time = 0.0;
+      return;
+    }
+    if (kMaxTrackedTenants < scheduling_class.tenant_finish_times.size()) {
+      std::erase_if(scheduling_class.tenant_finish_times, [&scheduling_class](const auto& tenant_finish_time) {
+        return tenant_finish_time.second <= scheduling_class.virtual_time;
+      });
+    }
+  }
+
+  const SchedulerConfig config_;
+
+  mutable std::mutex mutex_;
+  std::size_t in_flight_ = 0;
+  std::array<Class, kNumPriorities> classes_;
+  std::set<std::tuple<Clock::time_point, std::size_t, WaiterKey>> deadlines_;  // Of the waiting calls that have one.
+  std::uint64_t next_sequence_ = 0;
+};
+
+}  // namespace huggingface_api_cpp::inference
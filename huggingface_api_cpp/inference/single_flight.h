@@ -0,0 +1,72 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "huggingface_api_cpp/inference/cache_key.h"
+
+namespace huggingface_api_cpp::inference {
+
+// Coalesces concurrent calls with the same key: the first caller (the leader) performs the call, and the callers
+// joining while it is in flight (the followers) receive a copy of its result instead of performing their own.
+class SingleFlight {
+ public:
+  using Callback = std::function<void(std::string output_string)>;
+
+  // Returns true if the caller is the leader, which must call `complete()` with the result. Otherwise, `callback` is
+  // invoked by the leader's `complete()`.
+  bool join(const CacheKey& key, Callback callback) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto [it, is_leader] = in_flight_.try_emplace(key.hash);
+    if (is_leader) {
+      it->second.check = key.check;
+      return true;
+    }
+    if (it->second.check != key.check) {
+      return true;  // A hash collision. Performs the call independently instead of sharing the wrong result.
+    }
+    it->second.followers.push_back(std::move(callback));
+    num_coalesced_.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+
+  // Delivers `output_string` to the followers of `key`, and lets the next call with that key lead a new flight.
+  void complete(const CacheKey& key, const std::string& output_string) {
+    std::vector<Callback> followers;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      auto it = in_flight_.find(key.hash);
+      if (it == in_flight_.end() || it->second.check != key.check) {
+        return;
+      }
+      followers = std::move(it->second.followers);
+      in_flight_.erase(it);
+    }
+
+    for (Callback& follower : followers) {
+      follower(output_string);
+    }
+  }
+
+  // Number of calls served by another call's transfer.
+  std::uint64_t numCoalesced() const {
+    return num_coalesced_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  struct Flight {
+    std::uint64_t check = 0;
+    std::vector<Callback> followers;
+  };
+
+  std::mutex mutex_;
+  std::unordered_map<std::uint64_t, Flight> in_flight_;
+  std::atomic<std::uint64_t> num_coalesced_ = 0;
+};
+
+}  // namespace huggingface_api_cpp::inference
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace huggingface_api_cpp::inference {
+
+// A fixed number of worker threads consuming a bounded FIFO task queue.
+// Workers are spawned lazily on the first `post()`, so an idle pool costs no threads.
+class ThreadPool {
+ public:
+  using Task = std::function<void()>;
+
+  // `max_queue_size == 0` means the queue is unbounded.
+  ThreadPool(std::size_t num_threads = DefaultNumThreads(), std::size_t max_queue_size = 0)
+      : num_threads_(std::max<std::size_t>(num_threads, 1)), max_queue_size_(max_queue_size) {}
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  // Runs all the queued tasks, then joins the workers.
+  ~ThreadPool() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stopping_ = true;
+    }
+    task_queued_cv_.notify_all();
+    task_dequeued_cv_.notify_all();
+    for (std::thread& worker : workers_) {
+      worker.join();
+    }
+  }
+
+  // Enqueues `task`. Blocks the caller while the queue is full, which applies backpressure to producers.
+  void post(Task task) {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      if (workers_.empty()) {
+        for (std::size_t i = 0; i < num_threads_; ++i) {
+          workers_.emplace_back([this]() { run(); });
+        }
+      }
+      task_dequeued_cv_.wait(lock, [this]() {
+        return stopping_ || max_queue_size_ == 0 || tasks_.size() < max_queue_size_;
+      });
+      tasks_.push_back(std::move(task));
+    }
+    task_queued_cv_.notify_one();
+  }
+
+  std::size_t numThreads() const {
+    return num_threads_;
+  }
+
+  std::size_t queueSize() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return tasks_.size();
+  }
+
+  static std::size_t DefaultNumThreads() {
+    // Inference calls are I/O bound, so oversubscribes small machines a bit.
+    return std::max<std::size_t>(std::thread::hardware_concurrency(), 4);
+  }
+
+ private:
+  void run() {
+    while (true) {
+      Task task;
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        task_queued_cv_.wait(lock, [this]() { return stopping_ || !tasks_.empty(); });
+        if (tasks_.empty()) {
+          return;  // Stopping and drained.
+        }
+        task = std::move(tasks_.front());
+        tasks_.pop_front();
+      }
+      task_dequeued_cv_.notify_one();
+      task();
+    }
+  }
+
+  const std::size_t num_threads_;
+  const std::size_t max_queue_size_;
+
+  mutable std::mutex mutex_;
+  std::condition_variable task_queued_cv_;
+  std::condition_variable task_dequeued_cv_;
+  std::deque<Task> tasks_;
+  std::vector<std::thread> workers_;
+  bool stopping_ = false;
+};
+
+}  // namespace huggingface_api_cpp::inference
@@ -0,0 +1,274 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace huggingface_api_cpp::inference {
+
+struct TracerConfig {
+  // Once full, the ring buffer of a thread overwrites its oldest events. An event takes 40 bytes.
+  std::size_t events_per_thread = 16 * 1024;
+};
+
+struct TracerStats {
+  std::uint64_t events = 0;       // Recorded since the tracer was created.
+  std::uint64_t overwritten = 0;  // Of them, those lost to the wrap-around of the ring buffers.
+  std::size_t threads = 0;        // That have recorded events.
+};
+
+// Records the spans of the stages of the calls into a ring buffer per thread, without locking once a thread has its
+// buffer, and exports them in the Chrome trace event format, which chrome://tracing and https://ui.perfetto.dev open.
+//
+// A span that begins and ends on one thread is a complete event of that thread. A span that may end on another
+// thread, such as a transfer completed by an I/O thread, is an asynchronous event of its call, drawn on a track of
+// its own.
+class Tracer {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  Tracer(const TracerConfig& config = TracerConfig())
+      : config_(config), tracer_id_(NextTracerId()), start_time_(Clock::now()) {}
+
+  Tracer(const Tracer&) = delete;
+  Tracer& operator=(const Tracer&) = delete;
+
+  // An identifier for the asynchronous spans of one call.
+  std::uint64_t newCallId() {
+    return next_call_id_.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  // `name` must be a string literal, since only the pointer is stored. `call_id` may be 0 if there is no call.
+  void recordSpan(const char* name, std::uint64_t call_id, Clock::time_point begin, Clock::time_point end) {
+    record(EventKind::kSpan, name, call_id, begin, end);
+  }
+
+  void recordAsyncSpan(const char* name, std::uint64_t call_id, Clock::time_point begin, Clock::time_point end) {
+    record(EventKind::kAsyncSpan, name, call_id, begin, end);
+  }
+
+  TracerStats stats() const {
+    TracerStats stats;
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats.threads = rings_.size();
+    for (const auto& [thread_id, ring] : rings_) {
+      const std::uint64_t num_written = ring->num_written.load(std::memory_order_acquire);
+      stats.events += num_written;
+      stats.overwritten += num_written - std::min<std::uint64_t>(num_written, ring->slots.size());
+    }
+    return stats;
+  }
+
+  // The events that ended within `window` before now, or all the events still buffered if `window` is zero, as a
+  // Chrome trace JSON object. The timestamps are relative to the creation of the tracer.
+  std::string chromeTraceJson(Clock::duration window = Clock::duration::zero()) const {
+    const Clock::time_point now = Clock::now();
+    const std::int64_t min_end =
+        window == Clock::duration::zero() ? std::numeric_limits<std::int64_t>::min() : ToNanoseconds(now - window);
+
+    std::vector<std::pair<std::size_t, const Ring*>> rings;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      for (const auto& [thread_id, ring] : rings_) {
+        rings.emplace_back(ring->tid, ring.get());
+      }
+    }
+    std::sort(rings.begin(), rings.end());
+
+    std::string json = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    bool is_first = true;
+    auto append_event = [&json, &is_first](const std::string& event) {
+      if (!is_first) {
+        json += ",\n";
+      }
+      is_first = false;
+      json += event;
+    };
+
+    for (const auto& [tid, ring] : rings) {
+      append_event("{\"ph\":\"M\",\"pid\":1,\"tid\":" + std::to_string(tid) +
+                   ",\"name\":\"thread_name\",\"args\":{\"name\":\"thread " + std::to_string(tid) + "\"}}");
+      for (const Event& event : ring->read()) {
+        if (event.end_ns < min_end) {
+          continue;
+        }
+        const std::string common = "\"pid\":1,\"tid\":" + std::to_string(tid) + ",\"name\":\"" + event.name +
+                                   "\",\"cat\":\"hf_inference\"";
+        const std::string args = ",\"args\":{\"call\":" + std::to_string(event.call_id) + "}";
+        if (event.kind == EventKind::kSpan) {
+          append_event("{\"ph\":\"X\"," + common + ",\"ts\":" + Microseconds(event.begin_ns) +
+                       ",\"dur\":" + Microseconds(event.end_ns - event.begin_ns) + args + "}");
+        } else {
+          const std::string id = ",\"id\":" + std::to_string(event.call_id);
+          append_event("{\"ph\":\"b\"," + common + id + ",\"ts\":" + Microseconds(event.begin_ns) + args + "}");
+          append_event("{\"ph\":\"e\"," + common + id + ",\"ts\":" + Microseconds(event.end_ns) + "}");
+        }
+      }
+    }
+    json += "]}";
+    return json;
+  }
+
+ private:
+  enum class EventKind : std::uint8_t {
+    kSpan,
+    kAsyncSpan,
+  };
+
+  struct Event {
+    const char* name;
+    std::uint64_t call_id;
+    std::int64_t begin_ns;  // Since `start_time_`.
+    std::int64_t end_ns;
+    EventKind kind;
+  };
+
+  // The fields are relaxed atomics so that a reader may race with the writer overwriting a slot. It then discards the
+  // slot, since the count of written events tells which slots may have been overwritten.
+  struct Slot {
+    std::atomic<const char*> name = nullptr;
+    std::atomic<std::uint64_t> call_id = 0;
+    std::atomic<std::int64_t> begin_ns = 0;
+    std::atomic<std::int64_t> end_ns = 0;
+    std::atomic<EventKind> kind = EventKind::kSpan;
+  };
+
+  // Written by one thread only, read by any.
+  struct Ring {
+    Ring(std::size_t tid, std::size_t capacity) : tid(tid), slots(std::max<std::size_t>(capacity, 1)) {}
+
+    void write(const Event& event) {
+      const std::uint64_t index = num_written.load(std::memory_order_relaxed);
+      Slot& slot = slots[index % slots.size()];
+      // Marks the slot as being overwritten before writing it, for the readers that have read the count already.
+      overwriting.store(index + 1, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_release);
+      slot.name.store(event.name, std::memory_order_relaxed);
+      slot.call_id.store(event.call_id, std::memory_order_relaxed);
+      slot.begin_ns.store(event.begin_ns, std::memory_order_relaxed);
+      slot.end_ns.store(event.end_ns, std::memory_order_relaxed);
+      slot.kind.store(event.kind, std::memory_order_relaxed);
+      num_written.store(index + 1, std::memory_order_release);
+    }
+
+    // The events still in the buffer, oldest first.
+    std::vector<Event> read() const {
+      const std::uint64_t end = num_written.load(std::memory_order_acquire);
+      const std::uint64_t begin = end - std::min<std::uint64_t>(end, slots.size());
+      std::vector<Event> events;
+      events.reserve(end - begin);
+      for (std::uint64_t index = begin; index < end; ++index) {
+        const Slot& slot = slots[index % slots.size()];
+        events.push_back(Event{
+            slot.name.load(std::memory_order_relaxed),
+            slot.call_id.load(std::memory_order_relaxed),
+            slot.begin_ns.load(std::memory_order_relaxed),
+            slot.end_ns.load(std::memory_order_relaxed),
+            slot.kind.load(std::memory_order_relaxed),
+        });
+      }
+
+      // Drops the events whose slots the writer has started to overwrite meanwhile.
+      std::atomic_thread_fence(std::memory_order_acquire);
+      const std::uint64_t overwritten_end = overwriting.load(std::memory_order_relaxed);
+      const std::uint64_t first_valid = overwritten_end - std::min<std::uint64_t>(overwritten_end, slots.size());
+      if (begin < first_valid) {
+        events.erase(events.begin(), events.begin() + std::min<std::uint64_t>(first_valid - begin, events.size()));
+      }
+      return events;
+    }
+
+    const std::size_t tid;  // A small number, for the trace viewers.
+    std::vector<Slot> slots;
+    std::atomic<std::uint64_t> num_written = 0;
+    std::atomic<std::uint64_t> overwriting = 0;  // 1 + the index of the last event whose write has started.
+  };
+
+  void record(EventKind kind, const char* name, std::uint64_t call_id, Clock::time_point begin,
+              Clock::time_point end) {
+    ring().write(Event{name, call_id, ToNanoseconds(begin), ToNanoseconds(end), kind});
+  }
+
+  // The ring of the calling thread. A thread caches the ring of the last tracer it recorded into, so it looks its
+  // ring up under the lock only when it switches tracers.
+  Ring& ring() {
+    struct CachedRing {
+      std::uint64_t tracer_id = 0;
+      Ring* ring = nullptr;
+    };
+    thread_local CachedRing cached_ring;
+    if (cached_ring.tracer_id == tracer_id_) {
+      return *cached_ring.ring;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::unique_ptr<Ring>& ring = rings_[std::this_thread::get_id()];
+    if (!ring) {
+      ring = std::make_unique<Ring>(rings_.size(), config_.events_per_thread);
+    }
+    cached_ring = CachedRing{tracer_id_, ring.get()};
+    return *ring;
+  }
+
+  std::int64_t ToNanoseconds(Clock::time_point time) const {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(time - start_time_).count();
+  }
+
+  // With the microsecond integer part the Chrome trace format expects, and the nanoseconds as decimals.
+  static std::string Microseconds(std::int64_t nanoseconds) {
+    const std::string sign = nanoseconds < 0 ? "-" : "";
+    const std::uint64_t magnitude = nanoseconds < 0 ? -static_cast<std::uint64_t>(nanoseconds) : nanoseconds;
+    std::string decimals = std::to_string(magnitude % 1000);
+    decimals.insert(0, 3 - decimals.size(), '0');
+    return sign + std::to_string(magnitude / 1000) + "." + decimals;
+  }
+
+  // Tells the tracers apart in the thread-local caches, even if one is allocated where a destroyed one was.
+  static std::uint64_t NextTracerId() {
+    static std::atomic<std::uint64_t> next_tracer_id = 1;
+    return next_tracer_id.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  const TracerConfig config_;
+  const std::uint64_t tracer_id_;
+  const Clock::time_point start_time_;
+  std::atomic<std::uint64_t> next_call_id_ = 1;
+
+  mutable std::mutex mutex_;
+  std::unordered_map<std::thread::id, std::unique_ptr<Ring>> rings_;
+};
+
+// Records a span of the calling thread from its construction to its destruction, if `tracer` is not null.
+class TraceScope {
+ public:
+  TraceScope(Tracer* tracer, const char* name, std::uint64_t call_id = 0)
+      : tracer_(tracer), name_(name), call_id_(call_id),
+        begin_(tracer != nullptr ? Tracer::Clock::now() : Tracer::Clock::time_point()) {}
+
+  TraceScope(const TraceScope&) = delete;
+  TraceScope& operator=(const TraceScope&) = delete;
+
+  ~TraceScope() {
+    if (tracer_ != nullptr) {
+      tracer_->recordSpan(name_, call_id_, begin_, Tracer::Clock::now());
+    }
+  }
+
+ private:
+  Tracer* tracer_;
+  const char* name_;
+  std::uint64_t call_id_;
+  Tracer::Clock::time_point begin_;
+};
+
+}  // namespace huggingface_api_cpp::inference
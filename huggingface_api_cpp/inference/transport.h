@@ -0,0 +1,346 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <curl/curl.h>
+#include <curlpp/Easy.hpp>
+#include <curlpp/Exception.hpp>
+#include <curlpp/Infos.hpp>
+
+#include "huggingface_api_cpp/inference/connection_pool.h"
+#include "huggingface_api_cpp/inference/request_body.h"
+
+namespace huggingface_api_cpp::inference {
+
+// Cancels the transfer of a request from any thread. A cancelled transfer completes with a
+// `curlpp::LibcurlRuntimeError` of code `CURLE_ABORTED_BY_CALLBACK`, unless it has completed already.
+class Cancellation {
+ public:
+  void cancel() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    is_cancelled_.store(true, std::memory_order_relaxed);
+    if (on_cancel_) {
+      std::exchange(on_cancel_, nullptr)();
+    }
+  }
+
+  bool isCancelled() const {
+    return is_cancelled_.load(std::memory_order_relaxed);
+  }
+
+  // For the transports: registers `on_cancel` to abort the transfer promptly, e.g. by waking up its event loop. It is
+  // invoked at most once, under a lock that `resetOnCancel()` also takes. Returns false if cancelled already.
+  bool setOnCancel(std::function<void()> on_cancel) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (isCancelled()) {
+      return false;
+    }
+    on_cancel_ = std::move(on_cancel);
+    return true;
+  }
+
+  void resetOnCancel() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    on_cancel_ = nullptr;
+  }
+
+ private:
+  std::mutex mutex_;
+  std::atomic<bool> is_cancelled_ = false;
+  std::function<void()> on_cancel_;
+};
+
+// An immutable list of request headers, with the `curl_slist` that libcurl reads built once, so that the requests
+// sending the same headers share one list instead of each copying its own.
+class HeaderList {
+ public:
+  explicit HeaderList(std::vector<std::string> headers) : headers_(std::move(headers)), nodes_(headers_.size()) {
+    for (std::size_t i = 0; i < nodes_.size(); ++i) {
+      nodes_[i].data = headers_[i].data();
+      nodes_[i].next = (i + 1 < nodes_.size()) ? &nodes_[i + 1] : nullptr;
+    }
+  }
+
+  HeaderList(const HeaderList&) = delete;
+  HeaderList& operator=(const HeaderList&) = delete;
+
+  const std::vector<std::string>& headers() const {
+    return headers_;
+  }
+
+  // Null if there is no header. libcurl does not modify the list.
+  curl_slist* slist() const {
+    return nodes_.empty() ? nullptr : const_cast<curl_slist*>(nodes_.data());
+  }
+
+ private:
+  std::vector<std::string> headers_;
+  std::vector<curl_slist> nodes_;
+};
+
+struct HttpRequest {
+  std::string url;
+  std::shared_ptr<const HeaderList> headers;  // Optional.
+  RequestBody body;
+
+  // Sends Accept-Encoding with every encoding libcurl supports, which decodes the response body before delivering it.
+  bool accept_encoding = false;
+
+  // Receives the body of a successful (2xx) response chunk by chunk as it arrives. If empty, or for any other
+  // response, the body is accumulated into `HttpResponse::body` instead. May throw, which aborts the transfer.
+  std::function<void(const char* data, std::size_t size)> on_data;
+
+  std::shared_ptr<Cancellation> cancellation;  // Optional.
+};
+
+// The phase timings and the sizes of a transfer, as reported by libcurl. Each time is measured from the start of the
+// transfer to the end of its phase: the name lookup, the TCP connect, the TLS handshake, the request about to be sent,
+// the first response byte received, and the whole transfer.
+struct TransferInfo {
+  std::chrono::microseconds name_lookup_time = std::chrono::microseconds(0);
+  std::chrono::microseconds connect_time = std::chrono::microseconds(0);
+  std::chrono::microseconds app_connect_time = std::chrono::microseconds(0);
+  std::chrono::microseconds pretransfer_time = std::chrono::microseconds(0);
+  std::chrono::microseconds start_transfer_time = std::chrono::microseconds(0);
+  std::chrono::microseconds total_time = std::chrono::microseconds(0);
+  std::uint64_t bytes_sent = 0;      // Of the request body.
+  std::uint64_t bytes_received = 0;  // Of the response body as received, i.e. before decoding its Content-Encoding.
+};
+
+struct HttpResponse {
+  long response_code = 0;
+  std::string body;
+  std::optional<std::chrono::milliseconds> retry_after_opt;  // From the Retry-After header, if any.
+  TransferInfo transfer_info;
+
+  // Set if the transfer failed, e.g. a `curlpp::LibcurlRuntimeError` or an exception thrown by `on_data`.
+  std::exception_ptr exception_ptr;
+};
+
+// Performs HTTP POST requests. `completion` is invoked exactly once per request.
+class Transport {
+ public:
+  using Completion = std::function<void(HttpResponse http_response)>;
+
+  virtual ~Transport() = default;
+
+  virtual void perform(HttpRequest http_request, Completion completion) = 0;
+
+  // Whether `perform()` blocks the caller until the completion has been invoked.
+  virtual bool isBlocking() const = 0;
+};
+
+// The state of one in-flight request, shared by the transport implementations.
+struct Transfer {
+  HttpRequest http_request;
+  HttpResponse http_response;
+  Transport::Completion completion;
+  CURL* curl_handle = nullptr;
+
+  // Applies the request to `easy`, which must have been reset. `this` must outlive the transfer.
+  // Sets the options on the libcurl handle directly, since the curlpp options are allocated and copy their values.
+  void setUp(curlpp::Easy& easy) {
+    curl_handle = easy.getHandle();
+    curl_easy_setopt(curl_handle, CURLOPT_URL, http_request.url.c_str());
+    curl_easy_setopt(curl_handle, CURLOPT_HTTPHEADER, http_request.headers ? http_request.headers->slist() : nullptr);
+
+    // Points libcurl at the body instead of copying it.
+    curl_easy_setopt(curl_handle, CURLOPT_POSTFIELDS, http_request.body.data());
+    curl_easy_setopt(curl_handle, CURLOPT_POSTFIELDSIZE_LARGE, static_cast<curl_off_t>(http_request.body.size()));
+    curl_easy_setopt(curl_handle, CURLOPT_WRITEFUNCTION, &Transfer::Write);
+    curl_easy_setopt(curl_handle, CURLOPT_WRITEDATA, this);
+    curl_easy_setopt(curl_handle, CURLOPT_HEADERFUNCTION, &Transfer::Header);
+    curl_easy_setopt(curl_handle, CURLOPT_HEADERDATA, this);
+    curl_easy_setopt(curl_handle, CURLOPT_PRIVATE, this);
+    if (http_request.accept_encoding) {
+      curl_easy_setopt(curl_handle, CURLOPT_ACCEPT_ENCODING, "");  // An empty string means all the supported ones.
+    }
+    if (http_request.cancellation) {
+      curl_easy_setopt(curl_handle, CURLOPT_NOPROGRESS, 0L);
+      curl_easy_setopt(curl_handle, CURLOPT_XFERINFOFUNCTION, &Transfer::Progress);
+      curl_easy_setopt(curl_handle, CURLOPT_XFERINFODATA, this);
+    }
+  }
+
+  // Fills in the response after libcurl has finished the transfer with `curl_code`.
+  void finish(curlpp::Easy& easy, CURLcode curl_code, const char* error_message) {
+    http_response.response_code = curlpp::infos::ResponseCode::get(easy);
+    readTransferInfo();
+    if (curl_code != CURLE_OK && !http_response.exception_ptr) {
+      const bool is_cancelled = http_request.cancellation && http_request.cancellation->isCancelled();
+      const std::string reason = is_cancelled ? "Transfer cancelled."
+                                 : (error_message != nullptr && error_message[0] != '\0')
+                                     ? error_message : curl_easy_strerror(curl_code);
+      http_response.exception_ptr = std::make_exception_ptr(curlpp::LibcurlRuntimeError(reason, curl_code));
+    }
+  }
+
+  void readTransferInfo() {
+    auto get_time = [this](CURLINFO info) {
+      curl_off_t time = 0;
+      curl_easy_getinfo(curl_handle, info, &time);
+      return std::chrono::microseconds(time);
+    };
+    auto get_size = [this](CURLINFO info) {
+      curl_off_t size = 0;
+      curl_easy_getinfo(curl_handle, info, &size);
+      return static_cast<std::uint64_t>(std::max<curl_off_t>(size, 0));
+    };
+
+    TransferInfo& transfer_info = http_response.transfer_info;
+    transfer_info.name_lookup_time = get_time(CURLINFO_NAMELOOKUP_TIME_T);
+    transfer_info.connect_time = get_time(CURLINFO_CONNECT_TIME_T);
+    transfer_info.app_connect_time = get_time(CURLINFO_APPCONNECT_TIME_T);
+    transfer_info.pretransfer_time = get_time(CURLINFO_PRETRANSFER_TIME_T);
+    transfer_info.start_transfer_time = get_time(CURLINFO_STARTTRANSFER_TIME_T);
+    transfer_info.total_time = get_time(CURLINFO_TOTAL_TIME_T);
+    transfer_info.bytes_sent = get_size(CURLINFO_SIZE_UPLOAD_T);
+    transfer_info.bytes_received = get_size(CURLINFO_SIZE_DOWNLOAD_T);
+  }
+
+  void complete() {
+    if (http_request.cancellation) {
+      http_request.cancellation->resetOnCancel();
+    }
+    completion(std::move(http_response));
+  }
+
+  // Whether the body of the response being received goes to `HttpResponse::body` rather than to `on_data`.
+  bool isBodyAccumulated() const {
+    long response_code = 0;
+    curl_easy_getinfo(curl_handle, CURLINFO_RESPONSE_CODE, &response_code);
+    return !http_request.on_data || response_code < 200 || 300 <= response_code;
+  }
+
+  // An accumulated response body is reserved up to this size from its Content-Length, and grows past it.
+  static constexpr std::size_t kMaxReservedBodySize = 16 * 1024 * 1024;
+
+  // Uses the Content-Length header to reserve the accumulated body once, and the Retry-After header, in either of its
+  // forms: a number of seconds, or an HTTP date.
+  static std::size_t Header(char* data, std::size_t size, std::size_t nmemb, void* user_data) {
+    Transfer* transfer = static_cast<Transfer*>(user_data);
+    const std::size_t data_size = size * nmemb;
+    const std::string_view header(data, data_size);
+
+    constexpr std::string_view kContentLength = "content-length:";
+    if (const std::optional<std::string_view> value_opt = HeaderValue(header, kContentLength)) {
+      std::size_t content_length = 0;
+      const auto [end, error] = std::from_chars(value_opt->data(), value_opt->data() + value_opt->size(),
+                                                content_length);
+      if (error == std::errc() && end == value_opt->data() + value_opt->size() && transfer->isBodyAccumulated()) {
+        transfer->http_response.body.reserve(std::min(content_length, kMaxReservedBodySize));
+      }
+      return data_size;
+    }
+
+    constexpr std::string_view kRetryAfter = "retry-after:";
+    const std::optional<std::string_view> value_opt = HeaderValue(header, kRetryAfter);
+    if (!value_opt.has_value()) {
+      return data_size;
+    }
+    const std::string value(value_opt.value());
+    if (value.find_first_not_of("0123456789") == std::string::npos) {
+      transfer->http_response.retry_after_opt = std::chrono::seconds(std::stoll(value));
+    } else if (const std::time_t time = curl_getdate(value.c_str(), nullptr); time != -1) {
+      const std::time_t now = std::time(nullptr);
+      transfer->http_response.retry_after_opt = std::chrono::seconds(std::max<std::time_t>(time - now, 0));
+    }
+    return data_size;
+  }
+
+  // The trimmed value of `header` if it is named `name`, which is lowercase and ends with a colon.
+  static std::optional<std::string_view> HeaderValue(std::string_view header, std::string_view name) {
+    if (header.size() <= name.size() || curl_strnequal(header.data(), name.data(), name.size()) == 0) {
+      return std::nullopt;
+    }
+    header.remove_prefix(name.size());
+    const std::size_t value_begin = header.find_first_not_of(" \t");
+    const std::size_t value_end = header.find_last_not_of(" \t\r\n");
+    if (value_begin == std::string_view::npos || value_end == std::string_view::npos) {
+      return std::nullopt;
+    }
+    return header.substr(value_begin, value_end - value_begin + 1);
+  }
+
+  // Called by libcurl at least once per second while the transfer is in flight. A non-zero return aborts it.
+  static int Progress(void* user_data, curl_off_t, curl_off_t, curl_off_t, curl_off_t) {
+    Transfer* transfer = static_cast<Transfer*>(user_data);
+    return transfer->http_request.cancellation->isCancelled() ? 1 : 0;
+  }
+
+  static std::size_t Write(char* data, std::size_t size, std::size_t nmemb, void* user_data) {
+    Transfer* transfer = static_cast<Transfer*>(user_data);
+    const std::size_t data_size = size * nmemb;
+    if (transfer->isBodyAccumulated()) {
+      transfer->http_response.body.append(data, data_size);
+      return data_size;
+    }
+
+    try {
+      transfer->http_request.on_data(data, data_size);
+      return data_size;
+    }
+    catch (...) {
+      // Exceptions must not propagate through libcurl. Returning a short count aborts the transfer.
+      transfer->http_response.exception_ptr = std::current_exception();
+      return 0;
+    }
+  }
+};
+
+// Performs each request on the calling thread with a blocking `curlpp::Easy::perform()`, reusing keep-alive
+// connections from a `ConnectionPool`.
+class EasyTransport : public Transport {
+ public:
+  EasyTransport(const std::shared_ptr<ConnectionPool>& connection_pool) : connection_pool_(connection_pool) {}
+
+  void perform(HttpRequest http_request, Completion completion) override {
+    Transfer transfer{std::move(http_request), HttpResponse(), std::move(completion)};
+
+    try {
+      ConnectionPool::Handle connection = connection_pool_->acquire(transfer.http_request.url);
+      curlpp::Easy& curlpp_request = connection.easy();
+      transfer.setUp(curlpp_request);
+
+      CURLcode curl_code = CURLE_OK;
+      std::string error_message;
+      try {
+        curlpp_request.perform();
+      }
+      catch (const curlpp::LibcurlRuntimeError& e) {
+        curl_code = e.whatCode();
+        error_message = e.what();
+      }
+      transfer.finish(curlpp_request, curl_code, error_message.c_str());
+    }
+    catch (...) {
+      transfer.http_response.exception_ptr = std::current_exception();
+    }
+
+    transfer.complete();
+  }
+
+  bool isBlocking() const override {
+    return true;
+  }
+
+ private:
+  std::shared_ptr<ConnectionPool> connection_pool_;
+};
+
+}  // namespace huggingface_api_cpp::inference